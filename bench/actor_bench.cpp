@@ -0,0 +1,106 @@
+/**
+ * @file      actor_bench.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Benchmarks of actor table, router and actor mailbox
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_format.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/actor.h"
+#include "engine/router.h"
+
+namespace Truffle::Bench {
+namespace {
+
+/**
+ * ActorTableはアクターの参照を保持し続けるので、登録したアクターはプロセスの終了まで
+ * 破棄しない。同じコントローラー名で呼ばれた場合は登録済みのアクターを再利用する。
+ * @param controller
+ * @param count
+ * @return
+ */
+std::vector<std::unique_ptr<Actor>>& registerActors(
+    const std::string& controller, size_t count) {
+  static absl::flat_hash_map<std::string, std::vector<std::unique_ptr<Actor>>>
+      actors;
+  auto& registered = actors[controller];
+  while (registered.size() < count) {
+    registered.emplace_back(std::make_unique<Actor>(Address{
+        controller, absl::StrFormat("object_%d", registered.size())}));
+  }
+  return registered;
+}
+
+void BM_ActorTableLookup(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto controller = absl::StrFormat("lookup_%d", count);
+  registerActors(controller, count);
+  // 同じコントローラー内のアクターは線形探索されるので、最後のアクターを探す
+  const Address address{controller, absl::StrFormat("object_%d", count - 1)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ActorTable::lookup(address));
+  }
+}
+BENCHMARK(BM_ActorTableLookup)->RangeMultiplier(4)->Range(1, 1024);
+
+void BM_ActorTableLookupMiss(benchmark::State& state) {
+  const Address address{"lookup_missing", "object"};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ActorTable::lookup(address));
+  }
+}
+BENCHMARK(BM_ActorTableLookupMiss);
+
+void BM_ActorTableAdd(benchmark::State& state) {
+  auto& actor = *registerActors("add", 1).front();
+  // 登録済みのアドレスを渡し、テーブルを伸ばさずに重複判定の経路を計測する
+  const auto address = actor.address();
+  ActorTable::add(address, actor);
+  for (auto _ : state) {
+    ActorTable::add(address, actor);
+  }
+}
+BENCHMARK(BM_ActorTableAdd);
+
+void BM_RouterTransport(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto controller = absl::StrFormat("router_%d", count);
+  auto& actors = registerActors(controller, count);
+  auto& receiver = *actors.back();
+  const auto address = receiver.address();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Router::transport(address, Message{"message"}));
+    // メールボックスの上限に達しないように受け取っておく
+    benchmark::DoNotOptimize(receiver.recv());
+  }
+}
+BENCHMARK(BM_RouterTransport)->RangeMultiplier(8)->Range(1, 512);
+
+void BM_ActorSendRecv(benchmark::State& state) {
+  auto& actor = *registerActors("mailbox", 1).front();
+  const auto batch = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; ++i) {
+      actor.send(Message{"message"});
+    }
+    for (size_t i = 0; i < batch; ++i) {
+      benchmark::DoNotOptimize(actor.recv());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_ActorSendRecv)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(Actor::PENDING_MESSAGE_SIZE_LIMIT);
+
+}  // namespace
+}  // namespace Truffle::Bench
@@ -0,0 +1,93 @@
+/**
+ * @file      dispatch_bench.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Benchmarks of event dispatch fan-out
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include <SDL2/SDL.h>
+#include <absl/strings/str_format.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "engine/controller.h"
+#include "engine/event_table.h"
+#include "engine/object.h"
+#include "engine/scene.h"
+
+namespace Truffle::Bench {
+namespace {
+
+class BenchObject final : public TruffleInvisibleObject {
+ public:
+  BenchObject(std::string name, uint64_t& counter)
+      : TruffleInvisibleObject(std::move(name)) {
+    setEventCallback(EventMask::of(SDL_MOUSEMOTION),
+                     [&counter](SDL_Event&) { ++counter; });
+    setEventCallback(EventMask::of(SDL_KEYDOWN),
+                     [&counter](SDL_Event&) { ++counter; });
+  }
+};
+
+class BenchController final : public TruffleController {
+ public:
+  BenchController() : TruffleController("dispatch_bench") {}
+};
+
+/**
+ * N個のオブジェクトがハンドラーを登録したシーン。Dispatcher::handleEvents は
+ * 1イベント毎にこのテーブルを通して配送する。
+ */
+class DispatchFixture {
+ public:
+  explicit DispatchFixture(size_t object_count) : scene_("dispatch_bench") {
+    objects_.reserve(object_count);
+    for (size_t i = 0; i < object_count; ++i) {
+      objects_.emplace_back(std::make_unique<BenchObject>(
+          absl::StrFormat("object_%d", i), counter_));
+      controller_.appendObject(*objects_.back());
+    }
+    scene_.setController(controller_);
+    table_.build(scene_);
+  }
+
+  void dispatch(Event& e) { table_.dispatch(e); }
+  [[nodiscard]] uint64_t counter() const { return counter_; }
+
+ private:
+  uint64_t counter_ = 0;
+  BenchController controller_;
+  std::vector<std::unique_ptr<BenchObject>> objects_;
+  TruffleScene scene_;
+  EventDispatchTable table_;
+};
+
+void BM_DispatchFanOut(benchmark::State& state) {
+  DispatchFixture fixture(static_cast<size_t>(state.range(0)));
+  Event e{};
+  e.type = SDL_MOUSEMOTION;
+  for (auto _ : state) {
+    fixture.dispatch(e);
+  }
+  benchmark::DoNotOptimize(fixture.counter());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DispatchFanOut)->RangeMultiplier(4)->Range(1, 4096);
+
+// どのハンドラーも関心を持たないイベントの配送
+void BM_DispatchUnhandled(benchmark::State& state) {
+  DispatchFixture fixture(static_cast<size_t>(state.range(0)));
+  Event e{};
+  e.type = SDL_MOUSEWHEEL;
+  for (auto _ : state) {
+    fixture.dispatch(e);
+  }
+  benchmark::DoNotOptimize(fixture.counter());
+}
+BENCHMARK(BM_DispatchUnhandled)->RangeMultiplier(4)->Range(1, 4096);
+
+}  // namespace
+}  // namespace Truffle::Bench
@@ -0,0 +1,48 @@
+/**
+ * @file      font_bench.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Benchmarks of font storage
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include <absl/strings/str_format.h>
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include "headless_video.h"
+#include "wrapper/sdl2/font_storage.h"
+
+namespace Truffle::Bench {
+namespace {
+
+constexpr size_t MIN_FONT_SIZE = 8;
+
+void BM_FontStorageOpenFont(benchmark::State& state) {
+  const auto path = fontPath();
+  if (path.empty()) {
+    state.SkipWithError("no font configured; set TRUFFLE_BENCH_FONT");
+    return;
+  }
+  if (!std::filesystem::exists(path)) {
+    state.SkipWithError(
+        absl::StrFormat("font %s not found; set TRUFFLE_BENCH_FONT", path)
+            .c_str());
+    return;
+  }
+  FontStorage::loadFont("bench", path);
+
+  // 開いたことのあるサイズは再利用されるので、最初の1周だけがフォントの生成になる
+  const auto sizes = static_cast<size_t>(state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        FontStorage::openFont("bench", MIN_FONT_SIZE + i % sizes));
+    ++i;
+  }
+}
+BENCHMARK(BM_FontStorageOpenFont)->RangeMultiplier(4)->Range(1, 64);
+
+}  // namespace
+}  // namespace Truffle::Bench
@@ -0,0 +1,75 @@
+/**
+ * @file      headless_video.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Shared SDL setup for benchmarks
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "headless_video.h"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_Image.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_format.h>
+
+#include <cstdlib>
+#include <filesystem>
+
+#include "common/exception.h"
+#include "wrapper/sdl2/renderer_storage.h"
+#include "wrapper/sdl2/window.h"
+
+namespace Truffle::Bench {
+
+void initHeadlessVideo() {
+  static const bool initialized = [] {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0 ||
+        !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+      throw TruffleException(
+          absl::StrFormat("Failed to init SDL: %s", SDL_GetError()));
+    }
+    const auto& window =
+        Window::get("truffle_bench", 640, 480, SDL_WINDOW_HIDDEN);
+    RendererStorage::activateRenderer(window, SDL_RENDERER_SOFTWARE);
+    return true;
+  }();
+  static_cast<void>(initialized);
+}
+
+const std::string& solidImagePath(int width, int height) {
+  static absl::flat_hash_map<std::string, std::string> paths;
+  const auto key = absl::StrFormat("%dx%d", width, height);
+  if (auto it = paths.find(key); it != paths.end()) {
+    return it->second;
+  }
+
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+      0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+  if (!surface) {
+    throw TruffleException(
+        absl::StrFormat("Failed to create surface: %s", SDL_GetError()));
+  }
+  SDL_FillRect(surface, nullptr,
+               SDL_MapRGBA(surface->format, 0x30, 0x80, 0xc0, 0xff));
+  auto path = (std::filesystem::temp_directory_path() /
+               absl::StrFormat("truffle_bench_%s.bmp", key))
+                  .string();
+  const auto saved = SDL_SaveBMP(surface, path.c_str());
+  SDL_FreeSurface(surface);
+  if (saved != 0) {
+    throw TruffleException(
+        absl::StrFormat("Failed to write %s: %s", path, SDL_GetError()));
+  }
+  return paths.emplace(key, std::move(path)).first->second;
+}
+
+std::string fontPath() {
+  if (const char* path = std::getenv("TRUFFLE_BENCH_FONT"); path != nullptr) {
+    return path;
+  }
+  return TRUFFLE_BENCH_DEFAULT_FONT;
+}
+
+}  // namespace Truffle::Bench
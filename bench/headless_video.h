@@ -0,0 +1,38 @@
+/**
+ * @file      headless_video.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Shared SDL setup for benchmarks
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_BENCH_HEADLESS_VIDEO_H
+#define TRUFFLE_BENCH_HEADLESS_VIDEO_H
+
+#include <string>
+
+namespace Truffle::Bench {
+
+/**
+ * dummyビデオドライバーとソフトウェアレンダラーでSDLを初期化する。
+ * 何度呼んでも初期化は一度だけ行われる。
+ */
+void initHeadlessVideo();
+
+/**
+ * 単色で塗りつぶした画像を一時ファイルに書き出し、そのパスを返す
+ * @param width
+ * @param height
+ * @return
+ */
+const std::string& solidImagePath(int width, int height);
+
+/**
+ * ベンチマークに使うフォントのパスを返す。TRUFFLE_BENCH_FONT 環境変数で上書きできる。
+ * @return 環境変数もCMakeの TRUFFLE_BENCH_FONT も指定されていなければ空
+ */
+std::string fontPath();
+
+}  // namespace Truffle::Bench
+
+#endif  // TRUFFLE_BENCH_HEADLESS_VIDEO_H
@@ -0,0 +1,89 @@
+/**
+ * @file      render_bench.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Benchmarks of the render loop on a software renderer
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include <SDL2/SDL.h>
+#include <absl/strings/str_format.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "engine/render_command.h"
+#include "engine/render_context.h"
+#include "headless_video.h"
+#include "object/image.h"
+#include "wrapper/sdl2/layer_cache.h"
+#include "wrapper/sdl2/renderer_storage.h"
+#include "wrapper/sdl2/sprite_batcher.h"
+#include "wrapper/sdl2/texture.h"
+
+namespace Truffle::Bench {
+namespace {
+
+constexpr int IMAGE_SIZE = 32;
+
+std::vector<std::unique_ptr<Image>> createImages(size_t count) {
+  const auto& path = solidImagePath(IMAGE_SIZE, IMAGE_SIZE);
+  std::vector<std::unique_ptr<Image>> images;
+  images.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const auto x = static_cast<int>(i * 7 % (640 - IMAGE_SIZE));
+    const auto y = static_cast<int>(i * 13 % (480 - IMAGE_SIZE));
+    images.emplace_back(
+        std::make_unique<Image>(absl::StrFormat("image_%d", i), path, x, y));
+  }
+  return images;
+}
+
+// Dispatcherの1フレーム分の描画 (記録, 消去, 発行, 表示) を計測する
+void BM_RenderImages(benchmark::State& state) {
+  initHeadlessVideo();
+  auto images = createImages(static_cast<size_t>(state.range(0)));
+  auto* renderer = const_cast<SDL_Renderer*>(
+      RendererStorage::get().activeRenderer()->entity());
+  RenderCommandList commands;
+  SpriteBatcher batcher;
+  LayerCache layers;
+  RenderContext context{renderer, batcher, layers, 0, 0, 0};
+  for (auto _ : state) {
+    commands.clear();
+    for (auto& image : images) {
+      image->record(commands);
+    }
+    SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xff);
+    SDL_RenderClear(renderer);
+    batcher.begin(renderer);
+    commands.submit(context);
+    SDL_RenderPresent(renderer);
+  }
+  state.counters["draw_calls"] = batcher.drawCalls();
+  images.clear();
+  TextureReaper::collect();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RenderImages)->RangeMultiplier(4)->Range(1, 1024);
+
+// フレーム毎の記録のみ。描画のコストと分離して見るために計測する
+void BM_RecordImages(benchmark::State& state) {
+  initHeadlessVideo();
+  auto images = createImages(static_cast<size_t>(state.range(0)));
+  RenderCommandList commands;
+  for (auto _ : state) {
+    commands.clear();
+    for (auto& image : images) {
+      image->record(commands);
+    }
+    benchmark::DoNotOptimize(commands.commands().data());
+  }
+  images.clear();
+  TextureReaper::collect();
+}
+BENCHMARK(BM_RecordImages)->RangeMultiplier(4)->Range(1, 1024);
+
+}  // namespace
+}  // namespace Truffle::Bench
@@ -0,0 +1,57 @@
+/**
+ * @file      state_bench.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Benchmarks of stateful object manager
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "common/stateful_object_manager.h"
+
+namespace Truffle::Bench {
+namespace {
+
+enum class BenchState { Normal, Hovered, Unbound };
+
+struct BenchObject {
+  explicit BenchObject(int value) : value(value) {}
+  int value;
+};
+
+void BM_ActiveStateObject(benchmark::State& state) {
+  StatefulObjectManager<BenchObject, BenchState> manager;
+  manager.setInitStatefulObject(BenchState::Normal, 0);
+  manager.bindStatefulObject(BenchState::Hovered, 1);
+  manager.setStateTransition(BenchState::Normal, BenchState::Hovered);
+  manager.stateTransition(BenchState::Hovered);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manager.activeStateObject().value);
+  }
+}
+BENCHMARK(BM_ActiveStateObject);
+
+// 現在の状態にオブジェクトがなく、直前の状態のオブジェクトを返す場合
+void BM_ActiveStateObjectFallback(benchmark::State& state) {
+  StatefulObjectManager<BenchObject, BenchState> manager;
+  manager.setInitStatefulObject(BenchState::Normal, 0);
+  manager.setStateTransition(BenchState::Normal, BenchState::Unbound);
+  manager.stateTransition(BenchState::Unbound);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manager.activeStateObject().value);
+  }
+}
+BENCHMARK(BM_ActiveStateObjectFallback);
+
+void BM_ActiveStateObjectStateless(benchmark::State& state) {
+  StatefulObjectManager<BenchObject, NullState> manager;
+  manager.setInitStatefulObject(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manager.activeStateObject().value);
+  }
+}
+BENCHMARK(BM_ActiveStateObjectStateless);
+
+}  // namespace
+}  // namespace Truffle::Bench
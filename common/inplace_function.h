@@ -0,0 +1,141 @@
+/**
+ * @file      inplace_function.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Type-erased callable stored in a fixed inline buffer
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_INPLACE_FUNCTION_H
+#define TRUFFLE_INPLACE_FUNCTION_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Truffle {
+
+template <class Signature, size_t Capacity = 4 * sizeof(void*)>
+class InplaceFunction;
+
+/**
+ * std::function と同様に呼び出し可能オブジェクトを保持するが、ヒープへのフォールバックを
+ * 持たないクラス。Capacity を超える呼び出し可能オブジェクトはコンパイルエラーになる。
+ * thisやいくつかの参照をキャプチャしたラムダであれば既定の容量に収まる。
+ *
+ * @tparam R 戻り値の型
+ * @tparam Args 引数の型
+ * @tparam Capacity インラインバッファのサイズ
+ */
+template <class R, class... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+ public:
+  InplaceFunction() noexcept = default;
+  InplaceFunction(std::nullptr_t) noexcept {}
+
+  template <class F, class = std::enable_if_t<
+                         !std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+  InplaceFunction(F&& f) {
+    using Fn = std::decay_t<F>;
+    static_assert(std::is_invocable_r_v<R, Fn&, Args...>,
+                  "InplaceFunction requires a callable with matching signature");
+    static_assert(sizeof(Fn) <= Capacity,
+                  "callable is too large for InplaceFunction; capture less "
+                  "state or raise the capacity");
+    static_assert(alignof(Fn) <= alignof(Storage),
+                  "callable is over-aligned for InplaceFunction");
+    ::new (static_cast<void*>(&storage_)) Fn(std::forward<F>(f));
+    ops_ = &OPS<Fn>;
+  }
+
+  InplaceFunction(const InplaceFunction& other) : ops_(other.ops_) {
+    if (ops_) {
+      ops_->copy(&storage_, &other.storage_);
+    }
+  }
+
+  InplaceFunction(InplaceFunction&& other) noexcept : ops_(other.ops_) {
+    if (ops_) {
+      ops_->move(&storage_, &other.storage_);
+      other.ops_ = nullptr;
+    }
+  }
+
+  InplaceFunction& operator=(const InplaceFunction& other) {
+    if (this != &other) {
+      reset();
+      if (other.ops_) {
+        other.ops_->copy(&storage_, &other.storage_);
+        ops_ = other.ops_;
+      }
+    }
+    return *this;
+  }
+
+  InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.ops_) {
+        other.ops_->move(&storage_, &other.storage_);
+        ops_ = other.ops_;
+        other.ops_ = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  InplaceFunction& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  ~InplaceFunction() { reset(); }
+
+  R operator()(Args... args) const {
+    assert(ops_ != nullptr);
+    return ops_->invoke(&storage_, std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+ private:
+  using Storage = std::aligned_storage_t<Capacity, alignof(std::max_align_t)>;
+
+  struct Ops {
+    R (*invoke)(void*, Args&&...);
+    void (*copy)(void*, const void*);
+    void (*move)(void*, void*) noexcept;
+    void (*destroy)(void*) noexcept;
+  };
+
+  template <class Fn>
+  static constexpr Ops OPS = {
+      [](void* f, Args&&... args) -> R {
+        return (*static_cast<Fn*>(f))(std::forward<Args>(args)...);
+      },
+      [](void* dst, const void* src) {
+        ::new (dst) Fn(*static_cast<const Fn*>(src));
+      },
+      [](void* dst, void* src) noexcept {
+        ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+        static_cast<Fn*>(src)->~Fn();
+      },
+      [](void* f) noexcept { static_cast<Fn*>(f)->~Fn(); },
+  };
+
+  void reset() noexcept {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  mutable Storage storage_;
+  const Ops* ops_ = nullptr;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_INPLACE_FUNCTION_H
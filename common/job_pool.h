@@ -0,0 +1,227 @@
+/**
+ * @file      job_pool.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Work-stealing thread pool
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_JOB_POOL_H
+#define TRUFFLE_JOB_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "inplace_function.h"
+#include "non_copyable.h"
+
+namespace Truffle {
+
+/**
+ * ワーカー毎にジョブキューを持つワークスティーリング方式のスレッドプール。
+ * ワーカーは自身のキューの末尾からジョブを取り出し、空であれば他のワーカーのキューの
+ * 先頭からジョブを盗む。wait() を呼んだスレッドもジョブの実行に参加する。
+ * ジョブの数は atomic で数え、ロックはワーカーが眠る時と起こす時にのみ獲る。
+ */
+class JobPool : NonCopyable {
+ public:
+  using Job = InplaceFunction<void()>;
+
+  /**
+   * @param worker_count ワーカースレッド数。0であればハードウェアスレッド数から
+   * 呼び出し元のスレッドを除いた数になる。
+   */
+  explicit JobPool(size_t worker_count = 0) {
+    if (worker_count == 0) {
+      const auto hardware = std::thread::hardware_concurrency();
+      worker_count = hardware > 1 ? hardware - 1 : 1;
+    }
+    // 末尾のキューは wait() を呼ぶスレッドのためのもの
+    for (size_t i = 0; i < worker_count + 1; ++i) {
+      queues_.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < worker_count; ++i) {
+      workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+  }
+
+  ~JobPool() {
+    {
+      std::unique_lock<std::mutex> l(sleep_mux_);
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * ジョブを投入する。ワーカースレッドから投入されたジョブはそのワーカーのキューに、
+   * それ以外から投入されたジョブは各ワーカーのキューに順番に積まれる。
+   * @param job
+   */
+  void submit(Job job) {
+    const auto index = currentQueue() != nullptr
+                           ? current_index_
+                           : next_queue_.fetch_add(1) % workers_.size();
+    pending_.fetch_add(1);
+    // 積んだ直後に取り出されて減算が先行すると queued_ が桁あふれするので、先に加算する
+    queued_.fetch_add(1);
+    {
+      std::unique_lock<std::mutex> l(queues_[index]->mux);
+      queues_[index]->jobs.emplace_back(std::move(job));
+    }
+    wakeAll();
+  }
+
+  /**
+   * 投入されたすべてのジョブの完了を待つ。待機中は呼び出し元のスレッドもジョブを実行する。
+   * ジョブが例外を送出していた場合は、最初の例外を再送出する。
+   */
+  void wait() {
+    const auto self = queues_.size() - 1;
+    while (pending_.load() != 0) {
+      if (runOne(self)) {
+        continue;
+      }
+      // 実行できるジョブがなければ、完了するか新たに積まれるまで眠る
+      sleep([this] { return pending_.load() == 0 || queued_.load() > 0; });
+    }
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> l(error_mux_);
+      std::swap(error, error_);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  [[nodiscard]] size_t workerCount() const { return workers_.size(); }
+
+ private:
+  struct WorkerQueue {
+    std::mutex mux;
+    std::deque<Job> jobs;
+  };
+
+  void workerLoop(size_t index) {
+    current_pool_ = this;
+    current_index_ = index;
+    while (true) {
+      sleep([this] { return stop_ || queued_.load() > 0; });
+      {
+        std::unique_lock<std::mutex> l(sleep_mux_);
+        if (stop_) {
+          return;
+        }
+      }
+      while (runOne(index)) {
+      }
+    }
+  }
+
+  /**
+   * 条件が満たされるまで眠る
+   * @param ready sleep_mux_ を獲得した状態で評価される
+   */
+  template <class Fn>
+  void sleep(Fn&& ready) {
+    std::unique_lock<std::mutex> l(sleep_mux_);
+    sleepers_.fetch_add(1);
+    sleep_cv_.wait(l, std::forward<Fn>(ready));
+    sleepers_.fetch_sub(1);
+  }
+
+  /**
+   * 眠っているスレッドをすべて起こす。眠ろうとするスレッドは条件を確かめる前に
+   * sleepers_ を加算するので、0であれば起こす必要はない。空のロックは、条件を
+   * 確かめてから眠るまでの間の通知の取りこぼしを防ぐ
+   */
+  void wakeAll() {
+    if (sleepers_.load() > 0) {
+      { std::unique_lock<std::mutex> l(sleep_mux_); }
+      sleep_cv_.notify_all();
+    }
+  }
+
+  bool runOne(size_t self) {
+    Job job;
+    if (!pop(self, job) && !steal(self, job)) {
+      return false;
+    }
+    queued_.fetch_sub(1);
+    try {
+      job();
+    } catch (...) {
+      std::unique_lock<std::mutex> l(error_mux_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+    if (pending_.fetch_sub(1) == 1) {
+      // wait() で眠っているスレッドに完了を伝える
+      wakeAll();
+    }
+    return true;
+  }
+
+  bool pop(size_t self, Job& job) {
+    auto& queue = *queues_[self];
+    std::unique_lock<std::mutex> l(queue.mux);
+    if (queue.jobs.empty()) {
+      return false;
+    }
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+  }
+
+  bool steal(size_t self, Job& job) {
+    for (size_t i = 1; i < queues_.size(); ++i) {
+      auto& victim = *queues_[(self + i) % queues_.size()];
+      std::unique_lock<std::mutex> l(victim.mux);
+      if (!victim.jobs.empty()) {
+        job = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  WorkerQueue* currentQueue() const {
+    return current_pool_ == this ? queues_[current_index_].get() : nullptr;
+  }
+
+  static inline thread_local const JobPool* current_pool_ = nullptr;
+  static inline thread_local size_t current_index_ = 0;
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> next_queue_{0};
+  std::atomic<size_t> pending_{0};
+
+  // キューに積まれていて取り出されていないジョブの数
+  std::atomic<size_t> queued_{0};
+  // sleep() で眠っている、もしくは眠ろうとしているスレッドの数
+  std::atomic<size_t> sleepers_{0};
+  std::mutex sleep_mux_;
+  std::condition_variable sleep_cv_;
+  bool stop_ = false;
+
+  std::mutex error_mux_;
+  std::exception_ptr error_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_JOB_POOL_H
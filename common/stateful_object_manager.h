@@ -84,6 +84,21 @@ class StatefulObjectManager : NonCopyable {
     transition_table_[from].insert(to);
   }
 
+  /**
+   * 状態から遷移できる状態を取得する
+   *
+   * @param from ソース状態
+   * @return 遷移が定義されていなければ空
+   */
+  std::set<State> reachableStates(State from) {
+    std::unique_lock<std::mutex> l(mux_);
+    auto src_state = transition_table_.find(from);
+    if (src_state == transition_table_.end()) {
+      return {};
+    }
+    return src_state->second;
+  }
+
   /**
    * 状態遷移を行う
    *
@@ -0,0 +1,203 @@
+/**
+ * @file      trace.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Scoped profiling zones exported as Chrome trace events
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_TRACE_H
+#define TRUFFLE_TRACE_H
+
+/**
+ * TRUFFLE_ENABLE_TRACE が定義されている時のみ計測を行う。定義されていなければ
+ * TRUFFLE_TRACE_ZONE は何も生成しない。
+ *
+ * 使用例:
+ *   void Foo::bar() {
+ *     TRUFFLE_TRACE_ZONE("Foo::bar");
+ *     ...
+ *   }
+ */
+#define TRUFFLE_TRACE_CONCAT_IMPL(a, b) a##b
+#define TRUFFLE_TRACE_CONCAT(a, b) TRUFFLE_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef TRUFFLE_ENABLE_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "non_copyable.h"
+#include "singleton.h"
+
+#define TRUFFLE_TRACE_ZONE(name) \
+  ::Truffle::TraceZone TRUFFLE_TRACE_CONCAT(truffle_trace_zone_, __LINE__)(name)
+
+namespace Truffle {
+
+/**
+ * 1区間分の計測結果
+ */
+struct TraceEvent {
+  const char* name;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+};
+
+/**
+ * スレッド毎の計測結果のバッファ。書き込みは所有スレッドのみが行い、
+ * 読み込み側は公開済みの件数までを参照するのでロックを必要としない。
+ * 容量を超えた計測結果は破棄する。
+ */
+class TraceBuffer : NonCopyable {
+ public:
+  static constexpr size_t CAPACITY = 1 << 16;
+
+  explicit TraceBuffer(uint32_t thread_id)
+      : thread_id_(thread_id), events_(CAPACITY) {}
+
+  void push(const TraceEvent& event) {
+    const auto size = size_.load(std::memory_order_relaxed);
+    if (size == CAPACITY) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    events_[size] = event;
+    size_.store(size + 1, std::memory_order_release);
+  }
+
+  [[nodiscard]] size_t size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] const TraceEvent& at(size_t i) const { return events_[i]; }
+  [[nodiscard]] uint32_t threadId() const { return thread_id_; }
+  [[nodiscard]] uint64_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const uint32_t thread_id_;
+  std::vector<TraceEvent> events_;
+  std::atomic<size_t> size_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * スレッド毎のバッファを管理し、Chrome trace event形式で書き出すクラス。
+ * 書き出したファイルは chrome://tracing や Perfetto で読み込める。
+ */
+class Tracer : public MutableSingleton<Tracer> {
+ public:
+  /**
+   * 呼び出し元スレッドのバッファを返す。初回呼び出し時にのみロックを獲る。
+   * @return
+   */
+  static TraceBuffer& threadBuffer() {
+    thread_local TraceBuffer* buffer = Tracer::get().registerThread_();
+    return *buffer;
+  }
+
+  /**
+   * トレース開始からの経過時間をナノ秒で返す
+   * @return
+   */
+  static uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - Tracer::get().epoch_)
+        .count();
+  }
+
+  /**
+   * これまでの計測結果をChrome trace event形式のJSONで書き出す
+   * @param path
+   * @return 書き出しに成功したか
+   */
+  static bool dumpChromeTrace(const std::string& path) {
+    return Tracer::get().dumpChromeTrace_(path);
+  }
+
+ private:
+  friend class MutableSingleton<Tracer>;
+
+  Tracer() : epoch_(std::chrono::steady_clock::now()) {}
+
+  TraceBuffer* registerThread_() {
+    std::unique_lock<std::mutex> l(mux_);
+    buffers_.emplace_back(
+        std::make_unique<TraceBuffer>(static_cast<uint32_t>(buffers_.size())));
+    return buffers_.back().get();
+  }
+
+  bool dumpChromeTrace_(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+      return false;
+    }
+    std::unique_lock<std::mutex> l(mux_);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : buffers_) {
+      const auto size = buffer->size();
+      for (size_t i = 0; i < size; ++i) {
+        const auto& event = buffer->at(i);
+        out << (first ? "" : ",") << "{\"name\":\"" << event.name
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId()
+            << ",\"ts\":" << event.start_ns / 1000 << "."
+            << formatFraction(event.start_ns % 1000)
+            << ",\"dur\":" << event.duration_ns / 1000 << "."
+            << formatFraction(event.duration_ns % 1000) << "}";
+        first = false;
+      }
+    }
+    out << "]}\n";
+    return static_cast<bool>(out);
+  }
+
+  // trace eventの時刻はマイクロ秒なので、ナノ秒の端数を小数部の3桁で表す
+  static std::string formatFraction(uint64_t ns) {
+    std::string fraction = std::to_string(ns);
+    return std::string(3 - fraction.size(), '0') + fraction;
+  }
+
+  const std::chrono::steady_clock::time_point epoch_;
+  std::mutex mux_;
+  // スレッドの終了後も書き出せるように、バッファはTracerが所有する
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+};
+
+/**
+ * スコープの開始から終了までを1区間として記録する。名前は文字列リテラルに限る。
+ */
+class TraceZone : NonCopyable {
+ public:
+  template <size_t N>
+  explicit TraceZone(const char (&name)[N])
+      : name_(name), start_ns_(Tracer::now()) {}
+
+  ~TraceZone() {
+    // 初回のバッファ確保にかかる時間を区間に含めないよう、先に終了時刻を取る
+    const auto end_ns = Tracer::now();
+    Tracer::threadBuffer().push(
+        TraceEvent{name_, start_ns_, end_ns - start_ns_});
+  }
+
+ private:
+  const char* name_;
+  uint64_t start_ns_;
+};
+
+}  // namespace Truffle
+
+#else
+
+#define TRUFFLE_TRACE_ZONE(name) static_cast<void>(0)
+
+#endif  // TRUFFLE_ENABLE_TRACE
+
+#endif  // TRUFFLE_TRACE_H
@@ -9,7 +9,10 @@
 #ifndef TRUFFLE_FPS_H
 #define TRUFFLE_FPS_H
 
+#include <absl/strings/str_format.h>
+
 #include "engine/controller.h"
+#include "engine/metrics.h"
 #include "object/text.h"
 
 namespace Truffle {
@@ -18,20 +21,24 @@ class FpsController : public TruffleController {
  public:
   explicit FpsController(std::string name)
       : TruffleController(name),
-        text_(name + "_text", std::to_string(fps_) + " fps", 0, 0,
+        text_(name + "_text", "0.0 fps", 0, 0,
               Color{0xff, 0xff, 0xff, 0xff}, "lazy", 20) {
     appendObject(text_);
   }
 
-  void update(SDL_Event& ev) final {
-    text_.setText(std::to_string(fps_) + " fps");
+  /**
+   * 表示するフレーム時間の統計を更新する。テクスチャを生成するのでメインスレッドから呼ぶこと。
+   * @param fps
+   * @param frame フレーム時間の統計
+   */
+  void setStats(double fps, const FrameTimeStats& frame) {
+    text_.setText(
+        absl::StrFormat("%.1f fps  avg %.2fms  p99 %.2fms  max %.2fms", fps,
+                        frame.avg_ms, frame.p99_ms, frame.max_ms));
   }
 
-  void setFps(double fps) { fps_ = fps; }
-
  private:
   SolidText text_;
-  double fps_ = 0;
 };
 
 }  // namespace Truffle
@@ -8,6 +8,8 @@
 
 #include "actor.h"
 
+#include "common/trace.h"
+
 namespace Truffle {
 
 Actor::Actor(Address address) : address_(address) {
@@ -22,6 +24,7 @@ std::optional<Message> Actor::recv() {
 }
 
 std::optional<ActorRef> ActorTable::lookup_(Address address) {
+  TRUFFLE_TRACE_ZONE("ActorTable::lookup");
   // O(N) lookup
   if (table_.find(address.controller) == table_.end()) {
     Logger::log(LogLevel::DEBUG,
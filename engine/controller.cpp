@@ -9,6 +9,7 @@
 #include "controller.h"
 
 #include "common/exception.h"
+#include "revision.h"
 
 namespace Truffle {
 
@@ -20,6 +21,7 @@ void TruffleController::appendObject(TruffleVisibleObject& object) {
     throw TruffleException("Duplicated name object can't be registered");
   }
   visible_objects_.emplace(object.name(), object);
+  SceneGraphRevision::bump();
 }
 
 void TruffleController::appendObject(TruffleInvisibleObject& object) {
@@ -28,6 +30,7 @@ void TruffleController::appendObject(TruffleInvisibleObject& object) {
     throw TruffleException("Duplicated name object can't be registered");
   }
   invisible_objects_.emplace(object.name(), object);
+  SceneGraphRevision::bump();
 }
 
 }  // namespace Truffle
\ No newline at end of file
@@ -13,8 +13,10 @@
 #include <absl/container/flat_hash_map.h>
 
 #include <string>
+#include <vector>
 
 #include "common/non_copyable.h"
+#include "frame_context.h"
 #include "object.h"
 #include "wrapper/sdl2/event.h"
 
@@ -28,10 +30,25 @@ class TruffleController : NonCopyable {
   virtual void start(){};
 
   /**
-   * 毎フレーム毎に1回呼ばれるコールバック
+   * 毎フレーム毎に1回呼ばれるコールバック。そのフレームのイベントをすべて処理した後に
+   * 実行される。
+   * @param frame フレーム情報。並行に実行されるコントローラー間で共有される
+   */
+  virtual void tick(const FrameContext& frame){};
+
+  /**
+   * イベント毎に呼ばれるコールバック。1フレーム中のイベント数だけ呼ばれるので、
+   * 重い処理は tick() で行うこと。
    */
   virtual void update(Event&){};
 
+  /**
+   * 固定タイムステップ毎に呼ばれるコールバック。描画のフレームレートに依らず、
+   * EngineConfig::tick_rate で指定された頻度で実行される。
+   * @param dt 1ステップの長さ(秒)
+   */
+  virtual void fixedUpdate(double dt){};
+
   /**
    * オブジェクトを追加する。名前が重複していれば例外を発生する。
    * @param object
@@ -68,6 +85,34 @@ class TruffleController : NonCopyable {
 
   [[nodiscard]] const std::string& name() const& { return name_; }
 
+  /**
+   * tick() と fixedUpdate() を他のコントローラーと並行に実行してよいか
+   * @return
+   */
+  [[nodiscard]] bool threadSafe() const { return thread_safe_; }
+
+  /**
+   * 管理する可視オブジェクトが静止しているか
+   * @return
+   */
+  [[nodiscard]] bool isStatic() const { return static_; }
+
+  /**
+   * tick() と fixedUpdate() が読み込む共有リソースの名前
+   * @return
+   */
+  [[nodiscard]] const std::vector<std::string>& readSet() const& {
+    return read_set_;
+  }
+
+  /**
+   * tick() と fixedUpdate() が書き込む共有リソースの名前
+   * @return
+   */
+  [[nodiscard]] const std::vector<std::string>& writeSet() const& {
+    return write_set_;
+  }
+
  protected:
   /**
    * コントローラーのコンストラクタ
@@ -76,11 +121,47 @@ class TruffleController : NonCopyable {
    */
   TruffleController(std::string name);
 
+  /**
+   * tick() と fixedUpdate() がどのコントローラーとも並行に実行できることを宣言する。
+   * 並行実行時はワーカースレッドから呼ばれるため、描画やSDLの呼び出しを行ってはならない。
+   */
+  void declareThreadSafe() { thread_safe_ = true; }
+
+  /**
+   * 管理する可視オブジェクトがほとんど変化しないことを宣言する。描画順で連続する
+   * 静止したオブジェクトはまとめてテクスチャに描画され、毎フレーム1回のコピーで合成される。
+   * いずれかのオブジェクトが変化するとテクスチャは描画し直される。
+   * シーンに登録する前に呼ぶこと。
+   */
+  void declareStatic() { static_ = true; }
+
+  /**
+   * tick() と fixedUpdate() が共有リソースを読み込むことを宣言する。
+   * 同じリソースに書き込むコントローラーとは並行に実行されない。
+   * @param resource リソースの名前
+   */
+  void declareRead(std::string resource) {
+    read_set_.emplace_back(std::move(resource));
+  }
+
+  /**
+   * tick() と fixedUpdate() が共有リソースに書き込むことを宣言する。
+   * 同じリソースを読み書きするコントローラーとは並行に実行されない。
+   * @param resource リソースの名前
+   */
+  void declareWrite(std::string resource) {
+    write_set_.emplace_back(std::move(resource));
+  }
+
  private:
   absl::flat_hash_map<std::string, TruffleVisibleObjectRef> visible_objects_;
   absl::flat_hash_map<std::string, TruffleInvisibleObjectRef>
       invisible_objects_;
   std::string name_;
+  bool thread_safe_ = false;
+  bool static_ = false;
+  std::vector<std::string> read_set_;
+  std::vector<std::string> write_set_;
 };
 
 using TruffleControllerRef = std::reference_wrapper<TruffleController>;
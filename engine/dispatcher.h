@@ -11,17 +11,41 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
 
+#include "common/logger.h"
 #include "common/non_copyable.h"
 #include "common/singleton.h"
+#include "common/trace.h"
 #include "context.h"
 #include "controller/fps.h"
+#include "draw_list.h"
+#include "engine_config.h"
 #include "event.h"
+#include "event_table.h"
+#include "frame_context.h"
+#include "frame_pipeline.h"
+#include "input_recording.h"
+#include "input_service.h"
 #include "metrics.h"
+#include "pointer_router.h"
+#include "render_command.h"
+#include "render_context.h"
+#include "revision.h"
 #include "scene_manager.h"
+#include "scene_preloader.h"
+#include "scene_residency.h"
+#include "timestep.h"
+#include "update_scheduler.h"
 #include "wrapper/sdl2/renderer_storage.h"
+#include "wrapper/sdl2/sprite_batcher.h"
+#include "wrapper/sdl2/texture.h"
+#include "wrapper/sdl2/texture_loader.h"
 
 namespace Truffle {
 
@@ -29,41 +53,245 @@ template <class SceneState>
 class Dispatcher : public MutableSingleton<Dispatcher<SceneState>>,
                    NonCopyable {
  public:
+  // FPSオーバーレイを更新する間隔(フレーム数)
+  static constexpr uint64_t OVERLAY_REFRESH_FRAMES = 100;
+
   void run();
 
+  /**
+   * ヘッドレスモードで計測したフレーム時間の統計を返す
+   * @return
+   */
+  [[nodiscard]] FrameTimeStats frameTimeStats() const {
+    return FrameTimeStats::compute(frame_times_ms_);
+  }
+
+  /**
+   * シーン毎のテクスチャの常駐状況を返す。シミュレーション中に呼んではならない
+   * @return
+   */
+  [[nodiscard]] std::vector<SceneResidencyStats> sceneResidencyStats() const {
+    return scene_residency_.stats(scene_manager_.scenes());
+  }
+
  private:
   friend class MutableSingleton<Dispatcher<SceneState>>;
 
-  Dispatcher(SceneManager<SceneState>& m, bool enable_fps_calc = false)
+  Dispatcher(SceneManager<SceneState>& m, const EngineConfig& config)
       : scene_manager_(m),
         exit_handler_([](Event&) {}),
-        enable_fps_calc_(enable_fps_calc),
-        fps_controller_("fps") {
+        enable_fps_calc_(config.debug_fps),
+        fps_controller_("fps"),
+        timestep_(config.tick_rate, config.max_catchup_ticks),
+        pipelined_(config.pipelined_render),
+        damage_tracking_(config.damage_tracking),
+        texture_upload_budget_(
+            std::chrono::duration_cast<SteadyClock::duration>(
+                std::chrono::duration<double, std::milli>(
+                    config.texture_upload_budget_ms))),
+        scene_preloader_(config.scene_preload_budget),
+        scene_residency_(config.scene_residency_budget) {
+    initHeadless(config);
+    initInputRecording(config);
+    initLayerCache();
+    if (config.parallel_update) {
+      update_scheduler_ =
+          std::make_unique<UpdateScheduler>(config.update_worker_threads);
+    }
     if (enable_fps_calc_) {
-      FpsMetrics::get();
       Context::get().setController(fps_controller_);
     }
   }
 
   Dispatcher(SceneManager<SceneState>& m,
              CustomEventCallback dispatcher_exit_callback,
-             bool enable_fps_calc = false)
+             const EngineConfig& config)
       : scene_manager_(m),
         exit_handler_(std::move(dispatcher_exit_callback)),
-        enable_fps_calc_(enable_fps_calc),
-        fps_controller_("fps") {
+        enable_fps_calc_(config.debug_fps),
+        fps_controller_("fps"),
+        timestep_(config.tick_rate, config.max_catchup_ticks),
+        pipelined_(config.pipelined_render),
+        damage_tracking_(config.damage_tracking),
+        texture_upload_budget_(
+            std::chrono::duration_cast<SteadyClock::duration>(
+                std::chrono::duration<double, std::milli>(
+                    config.texture_upload_budget_ms))),
+        scene_preloader_(config.scene_preload_budget),
+        scene_residency_(config.scene_residency_budget) {
+    initHeadless(config);
+    initInputRecording(config);
+    initLayerCache();
+    if (config.parallel_update) {
+      update_scheduler_ =
+          std::make_unique<UpdateScheduler>(config.update_worker_threads);
+    }
     if (enable_fps_calc_) {
-      FpsMetrics::get();
       Context::get().setController(fps_controller_);
     }
   }
 
-  bool handleEvents();
+  /**
+   * ヘッドレスモードの仮想時計と終了フレーム数を設定する
+   * @param config
+   */
+  void initHeadless(const EngineConfig& config);
+
+  /**
+   * 入力イベントの記録もしくは再生を設定する
+   * @param config
+   */
+  void initInputRecording(const EngineConfig& config);
+
+  /**
+   * レンダラーが描画先テクスチャに対応していれば静的な区間のキャッシュを有効にする
+   */
+  void initLayerCache();
+
+  /**
+   * 指定されたフレーム数を描画し終えたか
+   * @return
+   */
+  [[nodiscard]] bool finished() const {
+    return frame_limit_ != 0 && presented_frames_ >= frame_limit_;
+  }
+
+  /**
+   * 直列にシミュレーションと描画を行う
+   */
+  void runSerial();
+
+  /**
+   * シミュレーションスレッドでフレームN+1を計算しながら、メインスレッドでフレームNを描画する
+   */
+  void runPipelined();
+
+  /**
+   * SDLのイベントキューからイベントを取り出す。メインスレッドから呼ぶこと。
+   * 再生中は入力イベントの代わりに記録されたイベントを取り出す。
+   * @param events 取り出したイベントの格納先
+   * @return 終了イベントを受け取った場合、もしくは再生が終わった場合はfalse
+   */
+  bool pollEvents(std::vector<Event>& events);
+
+  /**
+   * 記録された1フレーム分のイベントを取り出す
+   * @param events 取り出したイベントの格納先
+   * @return 再生が終わった場合はfalse
+   */
+  bool replayEvents(std::vector<Event>& events);
+
+  /**
+   * 描画先と同じ大きさのテクスチャを保持し、変化した範囲のみを再描画してから画面に
+   * 転写する。オーバーレイは転写の後に描画する。メインスレッドから呼ぶこと。
+   * @param context
+   * @param commands
+   */
+  void submitDamaged(RenderContext& context, const RenderCommandList& commands);
+
+  /**
+   * 破棄待ちのテクスチャを破棄し、遷移先のシーンの素材の先読みを進め、非同期に読み込んだ
+   * 画像のテクスチャを予算内で生成し、FPSオーバーレイを更新する。
+   * 描画中の命令もシミュレーションも存在しない時点でメインスレッドから呼ぶこと。
+   */
+  void afterFrame();
+
+  /**
+   * イベントをコントローラーとオブジェクトに配送する
+   * @param events
+   */
+  void handleEvents(std::vector<Event>& events);
+
+  /**
+   * 1フレーム分のシミュレーションを行い、描画命令を記録する
+   * @param events このフレームで処理するイベント
+   * @param commands 描画命令の記録先
+   */
+  void simulate(std::vector<Event>& events, RenderCommandList& commands);
+
+  /**
+   * 描画リストのうち描画範囲が矩形と重なるオブジェクトの描画命令を記録する。
+   * 静的な区間はキャッシュが古い時のみ記録し直し、キャッシュの合成を記録する。
+   * @param cull_rect
+   * @param commands 描画命令の記録先
+   * @return
+   */
+  DrawCounts recordDrawList(const SDL_Rect& cull_rect,
+                            RenderCommandList& commands);
+
+  /**
+   * 描画命令を実行して画面に表示する。メインスレッドから呼ぶこと。
+   * @param commands
+   */
+  void present(const RenderCommandList& commands);
+
+  /**
+   * 蓄積された時間に応じて固定ステップのシミュレーションを実行する
+   * @param elapsed 前フレームからの経過時間
+   */
+  void runFixedUpdates(SteadyClock::duration elapsed);
+
+  /**
+   * フレーム情報を更新し、各コントローラーのフレーム毎の処理を実行する
+   * @param elapsed 前フレームからの経過時間
+   */
+  void tickControllers(SteadyClock::duration elapsed);
+
+  /**
+   * 現在のシーンもしくはオブジェクトの登録状況が変化していれば、イベントの索引と
+   * 描画リストとポインターの索引とコントローラーの実行計画を再構築する。
+   * シーンが変化していれば常駐管理にも通知する
+   */
+  void refreshSceneIndices();
+
+  /**
+   * 現在のシーンのすべてのコントローラーに対して処理を実行する。並行実行が有効であれば
+   * 並行実行を宣言したコントローラーはワーカースレッドで実行される。
+   * @param fn
+   */
+  template <class Fn>
+  void forEachController(Fn&& fn);
 
   CustomEventCallback exit_handler_;
   SceneManager<SceneState>& scene_manager_;
   FpsController fps_controller_;
   bool enable_fps_calc_ = false;
+  FixedTimestep timestep_;
+  SteadyClockTimePoint previous_frame_;
+  bool pipelined_ = false;
+  // ヘッドレスモードでは実時間ではなく固定の仮想時間でフレームを進める
+  std::optional<SteadyClock::duration> virtual_frame_time_;
+  uint64_t frame_limit_ = 0;
+  uint64_t presented_frames_ = 0;
+  SteadyClockTimePoint previous_present_;
+  std::vector<double> frame_times_ms_;
+  std::unique_ptr<InputRecorder> input_recorder_;
+  std::unique_ptr<InputReplayer> input_replayer_;
+  InputFrame replay_frame_;
+  // 再生中は記録時の経過時間でシミュレーションを進める
+  std::optional<SteadyClock::duration> replayed_frame_time_;
+  FrameContext frame_context_;
+  SpriteBatcher sprite_batcher_;
+  EventDispatchTable event_table_;
+  DrawList draw_list_;
+  PointerRouter pointer_router_;
+  // 描画先の範囲。この範囲と重ならないオブジェクトは描画しない
+  SDL_Rect viewport_{};
+  // 変化した範囲のみを再描画する。再描画しない範囲は canvas_ に残っている内容を用いる
+  bool damage_tracking_ = false;
+  SDL_Texture* canvas_ = nullptr;
+  int canvas_width_ = 0;
+  int canvas_height_ = 0;
+  // 静止したオブジェクトの描画結果を保持する。描画先テクスチャに対応しなければ使わない
+  bool cache_static_layers_ = false;
+  LayerCache layer_cache_;
+  // 非同期に読み込んだ画像のテクスチャを1フレームで生成する時間の予算
+  SteadyClock::duration texture_upload_budget_;
+  ScenePreloader scene_preloader_;
+  SceneResidency scene_residency_;
+  std::unique_ptr<UpdateScheduler> update_scheduler_;
+  const TruffleScene* indexed_scene_ = nullptr;
+  uint64_t indexed_revision_ = 0;
 };
 
 template <class SceneState>
@@ -71,49 +299,454 @@ void Dispatcher<SceneState>::run() {
   // Call startup functions on root scene
   scene_manager_.currentScene().initScene();
 
+  previous_frame_ = SteadyClock::now();
+  previous_present_ = previous_frame_;
+  if (pipelined_) {
+    runPipelined();
+  } else {
+    runSerial();
+  }
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::initHeadless(const EngineConfig& config) {
+  if (!config.headless) {
+    return;
+  }
+  if (config.headless_frame_rate == 0) {
+    throw TruffleException("headless frame rate must be greater than 0");
+  }
+  virtual_frame_time_ = std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::duration<double>(1.0 / config.headless_frame_rate));
+  frame_limit_ = config.headless_frames;
+  frame_times_ms_.reserve(frame_limit_);
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::initInputRecording(const EngineConfig& config) {
+  if (!config.input_record_path.empty() &&
+      !config.input_replay_path.empty()) {
+    throw TruffleException("input recording and replay can't be enabled both");
+  }
+  if (!config.input_record_path.empty()) {
+    input_recorder_ =
+        std::make_unique<InputRecorder>(config.input_record_path);
+  }
+  if (!config.input_replay_path.empty()) {
+    input_replayer_ =
+        std::make_unique<InputReplayer>(config.input_replay_path);
+  }
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::initLayerCache() {
+  auto* renderer = const_cast<SDL_Renderer*>(
+      RendererStorage::get().activeRenderer()->entity());
+  cache_static_layers_ = SDL_RenderTargetSupported(renderer) == SDL_TRUE;
+  if (!cache_static_layers_) {
+    Logger::log(LogLevel::INFO,
+                "Renderer doesn't support render targets, static layers are "
+                "drawn every frame");
+  }
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::runSerial() {
+  std::vector<Event> events;
+  RenderCommandList commands;
   while (true) {
-    // Handle Event
-    if (!handleEvents()) {
+    events.clear();
+    if (!pollEvents(events)) {
       return;
     }
+    simulate(events, commands);
+    present(commands);
+    afterFrame();
+    if (finished()) {
+      return;
+    }
+  }
+}
 
-    SDL_SetRenderDrawColor(
-        const_cast<SDL_Renderer*>(
-            RendererStorage::get().activeRenderer()->entity()),
-        0xff, 0xff, 0xff, 0xff);
-    SDL_RenderClear(const_cast<SDL_Renderer*>(
-        RendererStorage::get().activeRenderer()->entity()));
+template <class SceneState>
+void Dispatcher<SceneState>::runPipelined() {
+  FramePipeline pipeline(
+      [this](std::vector<Event>& events, RenderCommandList& commands) {
+        simulate(events, commands);
+      });
 
-    // Controllers
-    for (auto& [_, controller] : scene_manager_.currentScene().controllers()) {
-      for (auto& [_, object] : controller.get().visibleObjects()) {
-        object.get().render();
-      }
+  std::vector<Event> events;
+  if (!pollEvents(events)) {
+    return;
+  }
+  pipeline.kick(events);
+  const auto* front = &pipeline.wait();
+  afterFrame();
+
+  while (true) {
+    events.clear();
+    if (!pollEvents(events)) {
+      return;
+    }
+    if (front->requiresSync()) {
+      // オブジェクトを直接描画する命令はシミュレーション中のオブジェクトを参照するので、
+      // 描画を終えてから次のフレームのシミュレーションを開始する
+      present(*front);
+      pipeline.kick(events);
+    } else {
+      pipeline.kick(events);
+      present(*front);
     }
+    front = &pipeline.wait();
+    // 直前に表示したフレームの描画命令はもう参照されない
+    afterFrame();
+    if (finished()) {
+      return;
+    }
+  }
+}
 
-    // TODO: render global controllers
+template <class SceneState>
+void Dispatcher<SceneState>::simulate(std::vector<Event>& events,
+                                      RenderCommandList& commands) {
+  // パイプライン実行時は別のフレームとして表示されるので、計測は描画命令と共に受け渡す
+  auto& phase_times = commands.phaseTimes();
+  phase_times = {};
+  {
+    ScopedPhaseTimer timer(FramePhase::Callbacks, &phase_times);
+    TRUFFLE_TRACE_ZONE("Dispatcher::handleEvents");
+    // ハンドラーが参照する入力状態をイベントの配送前に確定させる
+    InputService::advance(events);
+    handleEvents(events);
+  }
 
-    SDL_RenderPresent(const_cast<SDL_Renderer*>(
-        RendererStorage::get().activeRenderer()->entity()));
+  {
+    ScopedPhaseTimer timer(FramePhase::Update, &phase_times);
+    TRUFFLE_TRACE_ZONE("Dispatcher::update");
+    refreshSceneIndices();
+    auto current_frame = SteadyClock::now();
+    const auto elapsed = replayed_frame_time_.value_or(
+        virtual_frame_time_.value_or(current_frame - previous_frame_));
+    runFixedUpdates(elapsed);
+    tickControllers(elapsed);
+    previous_frame_ = current_frame;
+    if (input_recorder_) {
+      input_recorder_->writeFrame(frame_context_.frame, elapsed, events);
+    }
+  }
 
-    if (enable_fps_calc_) {
-      FpsMetrics::get().incFrame();
+  ScopedPhaseTimer timer(FramePhase::Render, &phase_times);
+  TRUFFLE_TRACE_ZONE("Dispatcher::record");
+  commands.clear();
+  commands.setAlpha(timestep_.alpha());
+  commands.setFrame(frame_context_.frame, frame_context_.delta_time);
+  pointer_router_.update(draw_list_, draw_list_.refresh());
+  if (cache_static_layers_ && !layer_cache_.available()) {
+    // キャッシュの作成に失敗したフレームの合成は欠けているので、全体を描画し直す
+    cache_static_layers_ = false;
+    draw_list_.damageAll();
+  }
+  const auto damage = draw_list_.takeDamage();
+  commands.setDamage(damage);
+
+  // 変化した範囲のみを再描画する場合は、その範囲と重なるオブジェクトのみを記録する
+  SDL_Rect cull_rect = viewport_;
+  bool unchanged = false;
+  if (damage_tracking_ && !damage.full) {
+    unchanged = damage.empty() ||
+                !SDL_IntersectRect(&viewport_, &damage.rect, &cull_rect);
+  }
+
+  DrawCounts counts;
+  if (unchanged) {
+    counts.culled = static_cast<uint32_t>(draw_list_.entries().size());
+  } else {
+    counts = recordDrawList(cull_rect, commands);
+  }
+  FrameProfiler::setDrawCounts(counts);
+
+  // TODO: render global controllers
+  commands.beginOverlay();
+  if (enable_fps_calc_) {
+    for (auto& [_, object] : fps_controller_.visibleObjects()) {
+      object.get().record(commands);
+    }
+  }
+}
 
-      if (FpsMetrics::get().shouldCalcFps()) {
-        fps_controller_.setFps(FpsMetrics::get().fps());
+template <class SceneState>
+DrawCounts Dispatcher<SceneState>::recordDrawList(const SDL_Rect& cull_rect,
+                                                  RenderCommandList& commands) {
+  DrawCounts counts;
+  const auto entries = draw_list_.entries();
+  absl::Span<const DrawList::StaticRun> runs;
+  if (cache_static_layers_) {
+    runs = draw_list_.staticRuns();
+  }
+  size_t run = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (run < runs.size() && runs[run].begin == i) {
+      const auto end = runs[run].end;
+      if (draw_list_.takeStale(run)) {
+        // キャッシュは変化した範囲に依らず全体を描画し直す
+        commands.beginLayerCache(run);
+        for (; i < end; ++i) {
+          if (!DrawList::intersects(entries[i], viewport_)) {
+            ++counts.culled;
+            continue;
+          }
+          entries[i].object->record(commands);
+          ++counts.drawn;
+        }
+        commands.endLayerCache();
+      } else {
+        counts.cached += static_cast<uint32_t>(end - i);
       }
+      commands.compositeLayer(run);
+      i = end - 1;
+      ++run;
+      continue;
+    }
+
+    const auto& entry = entries[i];
+    if (!DrawList::intersects(entry, cull_rect)) {
+      ++counts.culled;
+      continue;
     }
+    entry.object->record(commands);
+    ++counts.drawn;
   }
+  return counts;
 }
 
 template <class SceneState>
-bool Dispatcher<SceneState>::handleEvents() {
+void Dispatcher<SceneState>::present(const RenderCommandList& commands) {
+  auto* renderer = const_cast<SDL_Renderer*>(
+      RendererStorage::get().activeRenderer()->entity());
+  {
+    ScopedPhaseTimer timer(FramePhase::Render);
+    TRUFFLE_TRACE_ZONE("Dispatcher::submit");
+    RenderContext context{renderer,         sprite_batcher_,
+                          layer_cache_,     commands.alpha(),
+                          commands.frame(), commands.deltaTime()};
+    if (damage_tracking_) {
+      submitDamaged(context, commands);
+    } else {
+      SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xff);
+      SDL_RenderClear(renderer);
+      sprite_batcher_.begin(renderer);
+      commands.submit(context);
+    }
+  }
+
+  {
+    ScopedPhaseTimer timer(FramePhase::Present);
+    TRUFFLE_TRACE_ZONE("Dispatcher::present");
+    SDL_RenderPresent(renderer);
+  }
+
+  ++presented_frames_;
+  const auto current_present = SteadyClock::now();
+  const auto frame_time = current_present - previous_present_;
+  FrameProfiler::commitFrame(frame_time, commands.phaseTimes());
+  if (frame_limit_ != 0) {
+    frame_times_ms_.emplace_back(
+        std::chrono::duration<double, std::milli>(frame_time).count());
+  }
+  previous_present_ = current_present;
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::submitDamaged(RenderContext& context,
+                                           const RenderCommandList& commands) {
+  auto* renderer = context.renderer;
+  int width = 0;
+  int height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  if (!canvas_ || width != canvas_width_ || height != canvas_height_) {
+    auto* canvas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!canvas) {
+      Logger::log(LogLevel::WARN,
+                  absl::StrFormat("Failed to create canvas for damage "
+                                  "tracking, falls back to full redraw: %s",
+                                  SDL_GetError()));
+      damage_tracking_ = false;
+      SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xff);
+      SDL_RenderClear(renderer);
+      sprite_batcher_.begin(renderer);
+      commands.submit(context);
+      return;
+    }
+    SDL_SetRenderTarget(renderer, canvas);
+    SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xff);
+    SDL_RenderClear(renderer);
+    if (canvas_) {
+      // このフレームの描画命令は変化した範囲しか含まないので、以前の内容を引き継ぐ。
+      // 大きさの変化に伴う全体の再描画は次のフレームで行われる。
+      SDL_RenderCopy(renderer, canvas_, nullptr, nullptr);
+      TextureReaper::retire(canvas_);
+    }
+    canvas_ = canvas;
+    canvas_width_ = width;
+    canvas_height_ = height;
+  }
+
+  const auto& damage = commands.damage();
+  if (!damage.empty()) {
+    const SDL_Rect area =
+        damage.full ? SDL_Rect{0, 0, width, height} : damage.rect;
+    SDL_SetRenderTarget(renderer, canvas_);
+    SDL_RenderSetClipRect(renderer, &area);
+    SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xff);
+    SDL_RenderFillRect(renderer, &area);
+    sprite_batcher_.begin(renderer);
+    commands.submitScene(context);
+    SDL_RenderSetClipRect(renderer, nullptr);
+  }
+
+  SDL_SetRenderTarget(renderer, nullptr);
+  SDL_RenderCopy(renderer, canvas_, nullptr, nullptr);
+  sprite_batcher_.begin(renderer);
+  commands.submitOverlay(context);
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::afterFrame() {
+  TextureReaper::collect();
+  const auto& scene = scene_manager_.currentScene();
+  if (scene_preloader_.target() != &scene) {
+    const auto next = scene_manager_.nextScenes();
+    scene_preloader_.retarget(scene, next);
+    // シミュレーションを行っていない間に、遷移しうる解放済みのシーンを読み込み直す
+    scene_residency_.warm(scene, next, scene_manager_.scenes());
+  }
+  scene_preloader_.update();
+  TextureLoader::pump(texture_upload_budget_);
+
+  if (enable_fps_calc_ && presented_frames_ % OVERLAY_REFRESH_FRAMES == 0) {
+    fps_controller_.setStats(FrameProfiler::fps(),
+                             FrameProfiler::frameStats());
+  }
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::runFixedUpdates(SteadyClock::duration elapsed) {
+  const auto ticks = timestep_.advance(elapsed);
+  const auto dt = timestep_.tickSeconds();
+  for (uint32_t i = 0; i < ticks; ++i) {
+    forEachController(
+        [dt](TruffleController& controller) { controller.fixedUpdate(dt); });
+  }
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::tickControllers(SteadyClock::duration elapsed) {
+  frame_context_.delta_time = std::chrono::duration<double>(elapsed).count();
+  ++frame_context_.frame;
+
+  frame_context_.input = InputService::snapshot();
+
+  forEachController([this](TruffleController& controller) {
+    controller.tick(frame_context_);
+  });
+}
+
+template <class SceneState>
+template <class Fn>
+void Dispatcher<SceneState>::forEachController(Fn&& fn) {
+  if (update_scheduler_) {
+    update_scheduler_->run(std::forward<Fn>(fn));
+    return;
+  }
+  for (auto& [_, controller] : scene_manager_.currentScene().controllers()) {
+    fn(controller.get());
+  }
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::refreshSceneIndices() {
+  const auto& scene = scene_manager_.currentScene();
+  const auto revision = SceneGraphRevision::current();
+  if (indexed_scene_ == &scene && indexed_revision_ == revision) {
+    return;
+  }
+  if (indexed_scene_ != &scene) {
+    if (indexed_scene_) {
+      // 戻ってきた時にホバーしたままにならないよう、前のシーンのホバーを終える
+      pointer_router_.leave(*indexed_scene_);
+    }
+    // 索引を構築する前に、解放されていたテクスチャを読み込み直す
+    scene_residency_.visit(scene, scene_manager_.scenes());
+  }
+  event_table_.build(scene);
+  draw_list_.build(scene);
+  pointer_router_.build(draw_list_);
+  if (update_scheduler_) {
+    update_scheduler_->build(scene);
+  }
+  indexed_scene_ = &scene;
+  indexed_revision_ = revision;
+}
+
+template <class SceneState>
+bool Dispatcher<SceneState>::pollEvents(std::vector<Event>& events) {
+  ScopedPhaseTimer timer(FramePhase::EventPoll);
+  TRUFFLE_TRACE_ZONE("Dispatcher::pollEvents");
+  const auto previous_viewport = viewport_;
+  SDL_GetRendererOutputSize(
+      const_cast<SDL_Renderer*>(
+          RendererStorage::get().activeRenderer()->entity()),
+      &viewport_.w, &viewport_.h);
+  if (viewport_.w != previous_viewport.w ||
+      viewport_.h != previous_viewport.h) {
+    draw_list_.damageAll();
+  }
+
   Event e;
   while (SDL_PollEvent(&e) != 0) {
     if (e.type == SDL_QUIT) {
       exit_handler_(e);
       return false;
     }
+    // 再生中はエンジン内部のイベントのみを受け取り、実際の入力は無視する
+    if (input_replayer_ && InputRecordingFormat::recordable(e)) {
+      continue;
+    }
+    events.emplace_back(e);
+  }
+
+  if (input_replayer_) {
+    return replayEvents(events);
+  }
+  if (input_recorder_) {
+    // 再生時にはエンジン内部のイベントが記録されたイベントより先に処理されるので、
+    // 記録時も同じ順序で処理する
+    std::stable_partition(events.begin(), events.end(), [](const Event& e) {
+      return !InputRecordingFormat::recordable(e);
+    });
+  }
+  return true;
+}
+
+template <class SceneState>
+bool Dispatcher<SceneState>::replayEvents(std::vector<Event>& events) {
+  if (!input_replayer_->nextFrame(replay_frame_)) {
+    Logger::log(LogLevel::INFO, "input replay finished");
+    Event quit{};
+    quit.type = SDL_QUIT;
+    exit_handler_(quit);
+    return false;
+  }
+  events.insert(events.end(), replay_frame_.events.begin(),
+                replay_frame_.events.end());
+  replayed_frame_time_ = replay_frame_.elapsed;
+  return true;
+}
+
+template <class SceneState>
+void Dispatcher<SceneState>::handleEvents(std::vector<Event>& events) {
+  for (auto& e : events) {
     if (e.user.type == EV_SCENE_CHANGED) {
       scene_manager_.transitScene();
     }
@@ -123,21 +756,12 @@ bool Dispatcher<SceneState>::handleEvents() {
     }
 
     // Handle events related with hardware interruption
-    for (const auto& [_, controller] :
-         scene_manager_.currentScene().controllers()) {
-      for (const auto& [_, object] : controller.get().visibleObjects()) {
-        for (const auto& callback : object.get().eventCallbacks()) {
-          callback(e);
-        }
-      }
-      for (const auto& [_, object] : controller.get().invisibleObjects()) {
-        for (const auto& callback : object.get().eventCallbacks()) {
-          callback(e);
-        }
-      }
-    }
+    refreshSceneIndices();
+    event_table_.dispatch(e);
+    pointer_router_.dispatch(e);
   }
-  return true;
+  refreshSceneIndices();
+  pointer_router_.updateHover();
 }
 
 }  // namespace Truffle
@@ -0,0 +1,191 @@
+/**
+ * @file      draw_list.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Scene objects ordered by layer, z and texture
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "draw_list.h"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+#include "controller.h"
+#include "revision.h"
+
+namespace Truffle {
+
+void DrawList::build(const TruffleScene& scene) {
+  struct Named {
+    const std::string* controller;
+    TruffleVisibleObject* object;
+    bool controller_static;
+  };
+
+  std::vector<Named> named;
+  for (const auto& [controller_name, controller] : scene.controllers()) {
+    const bool controller_static = controller.get().isStatic();
+    for (auto& [_, object] : controller.get().visibleObjects()) {
+      named.emplace_back(
+          Named{&controller_name, &object.get(), controller_static});
+    }
+  }
+  // ハッシュマップの走査順に依らないように、名前で順序を決める
+  std::sort(named.begin(), named.end(), [](const Named& a, const Named& b) {
+    return std::tie(*a.controller, a.object->name()) <
+           std::tie(*b.controller, b.object->name());
+  });
+
+  revision_ = DrawOrderRevision::current();
+  damage_.addAll();
+  static_layers_ = scene.staticLayers();
+  static_runs_.clear();
+  texture_ids_.clear();
+  entries_.clear();
+  entries_.reserve(named.size());
+  for (const auto& [_, object, controller_static] : named) {
+    Entry entry{};
+    entry.order = static_cast<uint32_t>(entries_.size());
+    entry.object = object;
+    entry.controller_static = controller_static;
+    updateKey(entry);
+    entries_.emplace_back(entry);
+  }
+  std::sort(entries_.begin(), entries_.end(), before);
+  updateStaticRuns();
+}
+
+DrawList::Change DrawList::refresh() {
+  const auto revision = DrawOrderRevision::current();
+  if (revision == revision_) {
+    return Change::None;
+  }
+  revision_ = revision;
+
+  bool changed = false;
+  bool rekeyed = false;
+  for (auto& entry : entries_) {
+    auto& object = *entry.object;
+    entry.changed = object.draw_order_dirty_ || object.bounds_dirty_ ||
+                    object.content_dirty_;
+    if (!entry.changed) {
+      continue;
+    }
+    changed = true;
+    // 移動前と移動後の双方を再描画する
+    damage_.add(entry.bounds);
+    if (object.draw_order_dirty_) {
+      updateKey(entry);
+      rekeyed = true;
+    } else {
+      entry.bounds = object.renderRect();
+      object.bounds_dirty_ = false;
+      object.content_dirty_ = false;
+    }
+    damage_.add(entry.bounds);
+  }
+
+  // キーが変わっても順位が動かなければ、索引は範囲の更新のみで済む
+  bool reordered = false;
+  if (rekeyed) {
+    for (size_t i = 1; i < entries_.size(); ++i) {
+      if (!before(entries_[i], entries_[i - 1])) {
+        continue;
+      }
+      reordered = true;
+      auto entry = entries_[i];
+      size_t j = i;
+      for (; j > 0 && before(entry, entries_[j - 1]); --j) {
+        entries_[j] = entries_[j - 1];
+      }
+      entries_[j] = entry;
+    }
+  }
+  updateStaticRuns();
+
+  if (reordered) {
+    return Change::Order;
+  }
+  return changed ? Change::Bounds : Change::None;
+}
+
+DamageRegion DrawList::takeDamage() {
+  auto damage = damage_;
+  damage_.reset();
+  return damage;
+}
+
+void DrawList::damageAll() {
+  damage_.addAll();
+  for (auto& run : static_runs_) {
+    run.stale = true;
+  }
+}
+
+bool DrawList::takeStale(size_t run) {
+  const bool stale = static_runs_[run].stale;
+  static_runs_[run].stale = false;
+  return stale;
+}
+
+void DrawList::updateStaticRuns() {
+  const auto previous = std::move(static_runs_);
+  static_runs_.clear();
+  size_t begin = 0;
+  for (size_t i = 0; i <= entries_.size(); ++i) {
+    if (i < entries_.size() && entries_[i].is_static) {
+      continue;
+    }
+    if (i - begin >= MIN_STATIC_RUN && static_runs_.size() < MAX_STATIC_RUNS) {
+      static_runs_.emplace_back(StaticRun{begin, i, true});
+    }
+    begin = i + 1;
+  }
+
+  for (size_t i = 0; i < static_runs_.size(); ++i) {
+    auto& run = static_runs_[i];
+    if (i < previous.size() && previous[i].begin == run.begin &&
+        previous[i].end == run.end) {
+      run.stale = previous[i].stale;
+      for (size_t j = run.begin; j < run.end && !run.stale; ++j) {
+        run.stale = entries_[j].changed;
+      }
+    }
+  }
+}
+
+bool DrawList::before(const Entry& a, const Entry& b) {
+  if (a.layer != b.layer) {
+    return a.layer < b.layer;
+  }
+  if (a.z != b.z) {
+    return a.z < b.z;
+  }
+  if (a.texture_id != b.texture_id) {
+    return a.texture_id < b.texture_id;
+  }
+  return a.order < b.order;
+}
+
+void DrawList::updateKey(Entry& entry) {
+  auto& object = *entry.object;
+  entry.layer = object.layer();
+  entry.is_static =
+      entry.controller_static || static_layers_.contains(entry.layer);
+  entry.z = object.z();
+  if (const auto* texture = object.drawTexture()) {
+    // 名前順に走査する build() から振るので、同じシーンであれば実行毎に同じ番号になる
+    const auto next_id = static_cast<uint32_t>(texture_ids_.size() + 1);
+    entry.texture_id = texture_ids_.try_emplace(texture, next_id).first->second;
+  } else {
+    entry.texture_id = 0;
+  }
+  entry.bounds = object.renderRect();
+  object.draw_order_dirty_ = false;
+  object.bounds_dirty_ = false;
+  object.content_dirty_ = false;
+}
+
+}  // namespace Truffle
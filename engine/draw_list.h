@@ -0,0 +1,158 @@
+/**
+ * @file      draw_list.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Scene objects ordered by layer, z and texture
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_DRAW_LIST_H
+#define TRUFFLE_DRAW_LIST_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/types/span.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "object.h"
+#include "render_command.h"
+#include "scene.h"
+
+namespace Truffle {
+
+/**
+ * シーン内の可視オブジェクトを描画順に並べた連続領域。(レイヤー, z, テクスチャ) の順に
+ * 並べるので、描画順が決定的になり、同じテクスチャを用いるオブジェクトが連続する。
+ * オブジェクトのレイヤー・z・テクスチャが変わった時にのみ並べ直す。
+ */
+class DrawList {
+ public:
+  // 静的な区間としてキャッシュする最小のオブジェクト数。これより少なければ毎フレーム描画する
+  static constexpr size_t MIN_STATIC_RUN = 4;
+  // キャッシュする静的な区間の最大数。区間毎に描画先と同じ大きさのテクスチャを確保する
+  static constexpr size_t MAX_STATIC_RUNS = 4;
+
+  struct Entry {
+    int32_t layer;
+    int32_t z;
+    // drawTexture() の識別子。アドレスは実行毎に変わるので、build() 以降に初めて
+    // 現れた順に振った番号で並べる。テクスチャを持たなければ0
+    uint32_t texture_id;
+    // 上記が等しい場合の順序。コントローラー名とオブジェクト名の順
+    uint32_t order;
+    // オブジェクトの renderRect() の写し。画面外の判定でオブジェクトを参照せずに済む
+    SDL_Rect bounds;
+    TruffleVisibleObject* object;
+    // 静止していると宣言されたコントローラーに属する
+    bool controller_static;
+    // 静止していると宣言されたコントローラーもしくはレイヤーに属する
+    bool is_static;
+    // 直近の refresh() で変化した
+    bool changed;
+  };
+
+  /**
+   * 描画順で連続する静止したオブジェクトの区間 [begin, end)。区間のインデックスを
+   * LayerCache のスロットとして用いる。
+   */
+  struct StaticRun {
+    size_t begin;
+    size_t end;
+    // キャッシュを描画し直す必要がある
+    bool stale;
+  };
+
+  /**
+   * シーンに属するすべての可視オブジェクトからリストを再構築する
+   * @param scene
+   */
+  void build(const TruffleScene& scene);
+
+  /**
+   * refresh() で起きた変化
+   */
+  enum class Change {
+    // 変化したオブジェクトはない
+    None,
+    // 描画範囲・見た目・キーが変化したが、エントリの順位は変わっていない。
+    // 変化したエントリは Entry::changed が立つ
+    Bounds,
+    // エントリの順位が変化した
+    Order,
+  };
+
+  /**
+   * 前回から描画順が変わったオブジェクトがあれば、そのキーを更新して並べ直す。
+   * ほぼ整列済みの列に対する挿入ソートなので、変化したオブジェクトが少なければ線形時間で済む。
+   * 描画範囲が変わったオブジェクトは範囲のみを更新する。
+   * @return
+   */
+  Change refresh();
+
+  /**
+   * 描画範囲がビューポートと重なるか。範囲が空のオブジェクトは描画範囲が不明なので
+   * 常に重なるものとして扱う。
+   * @param entry
+   * @param viewport
+   * @return
+   */
+  static bool intersects(const Entry& entry, const SDL_Rect& viewport) {
+    if (entry.bounds.w <= 0 || entry.bounds.h <= 0) {
+      return true;
+    }
+    return SDL_HasIntersection(&entry.bounds, &viewport) == SDL_TRUE;
+  }
+
+  /**
+   * 前回の takeDamage() 以降に描画内容が変わった範囲を返し、リセットする。
+   * build() の後は全体が変わったものとする。
+   * @return
+   */
+  DamageRegion takeDamage();
+
+  /**
+   * 描画先の大きさが変わった時など、全体を変化したものとする
+   */
+  void damageAll();
+
+  /**
+   * 静的な区間のキャッシュを描画し直す必要があるかを返し、リセットする
+   * @param run 区間のインデックス
+   * @return
+   */
+  bool takeStale(size_t run);
+
+  [[nodiscard]] absl::Span<const Entry> entries() const& { return entries_; }
+
+  /**
+   * 静的な区間。描画順に並んでいる
+   * @return
+   */
+  [[nodiscard]] absl::Span<const StaticRun> staticRuns() const& {
+    return static_runs_;
+  }
+
+ private:
+  static bool before(const Entry& a, const Entry& b);
+  void updateKey(Entry& entry);
+
+  /**
+   * 静的な区間を求め直す。前回と範囲が異なる区間と、変化したオブジェクトを含む区間は
+   * 描画し直す。
+   */
+  void updateStaticRuns();
+
+  std::vector<Entry> entries_;
+  absl::flat_hash_map<SDL_Texture const*, uint32_t> texture_ids_;
+  absl::flat_hash_set<int32_t> static_layers_;
+  std::vector<StaticRun> static_runs_;
+  uint64_t revision_ = 0;
+  DamageRegion damage_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_DRAW_LIST_H
@@ -12,14 +12,20 @@
 #include <SDL2/SDL_Image.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "common/trace.h"
 #include "dispatcher.h"
 #include "engine_config.h"
 #include "scene_manager.h"
+#include "wrapper/sdl2/asset_pack.h"
 #include "wrapper/sdl2/font.h"
 #include "wrapper/sdl2/font_storage.h"
 #include "wrapper/sdl2/renderer.h"
 #include "wrapper/sdl2/renderer_storage.h"
+#include "wrapper/sdl2/texture_atlas.h"
+#include "wrapper/sdl2/texture_cache.h"
 #include "wrapper/sdl2/window.h"
 
 namespace Truffle {
@@ -50,9 +56,23 @@ class Engine {
    */
   void start();
 
+  /**
+   * ヘッドレスモードで計測したフレーム時間の統計を返す
+   * @return
+   */
+  FrameTimeStats frameTimeStats() const;
+
+  /**
+   * シーン毎のテクスチャの常駐状況を返す
+   * @return
+   */
+  std::vector<SceneResidencyStats> sceneResidencyStats() const;
+
  private:
   std::unique_ptr<SceneManager<SceneState>> scene_manager_;
   std::unique_ptr<Dispatcher<SceneState>> dispatcher_;
+  bool headless_ = false;
+  std::string trace_output_path_;
 };
 
 template <class SceneState>
@@ -61,13 +81,33 @@ Engine<SceneState>::Engine(EngineConfig& config) {
     throw TruffleException("Failed to init engine");
   }
 
-  const auto& window_tmp =
-      Window::get(config.name, config.window_width, config.window_height);
+  uint32_t window_flags = SDL_WINDOW_SHOWN;
+  uint32_t renderer_flags =
+      SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
+  if (config.headless) {
+    // GPUのない環境でも動作し、垂直同期に律速されないようにする
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    window_flags = SDL_WINDOW_HIDDEN;
+    renderer_flags = SDL_RENDERER_SOFTWARE;
+  }
+  headless_ = config.headless;
+  trace_output_path_ = config.trace_output_path;
+
+  const auto& window_tmp = Window::get(config.name, config.window_width,
+                                       config.window_height, window_flags);
 
   auto& renderer_storage_tmp = RendererStorage::get();
-  renderer_storage_tmp.activateRenderer(window_tmp);
+  renderer_storage_tmp.activateRenderer(window_tmp, renderer_flags);
   renderer_storage_tmp.activeRenderer()->setDrawColor(config.renderer_color);
 
+  for (const auto& path : config.asset_pack_paths) {
+    AssetPackStorage::mount(path);
+  }
+  if (!config.atlas_image_paths.empty()) {
+    TextureAtlas::pack(config.atlas_image_paths);
+  }
+  TextureCache::setBudget(config.texture_cache_budget);
+
   auto& font_storage_tmp = FontStorage::get();
   if (!config.font_paths.empty()) {
     for (const auto& [font_name, path] : config.font_paths) {
@@ -77,7 +117,7 @@ Engine<SceneState>::Engine(EngineConfig& config) {
 
   scene_manager_ = std::make_unique<SceneManager<SceneState>>();
   auto& dispatcher_tmp =
-      Dispatcher<SceneState>::get(*scene_manager_, config.debug_fps);
+      Dispatcher<SceneState>::get(*scene_manager_, config);
   dispatcher_ = std::unique_ptr<Dispatcher<SceneState>>(&dispatcher_tmp);
 }
 
@@ -103,6 +143,66 @@ template <class SceneState>
 void Engine<SceneState>::start() {
   assert(dispatcher_ != nullptr);
   dispatcher_->run();
+
+#ifdef TRUFFLE_ENABLE_TRACE
+  if (!trace_output_path_.empty() &&
+      !Tracer::dumpChromeTrace(trace_output_path_)) {
+    Logger::log(LogLevel::WARN, absl::StrFormat("Failed to write trace to %s",
+                                                trace_output_path_));
+  }
+#endif
+
+  if (headless_) {
+    const auto stats = dispatcher_->frameTimeStats();
+    Logger::log(LogLevel::INFO,
+                absl::StrFormat("headless run finished: frames=%d min=%.3fms "
+                                "avg=%.3fms p50=%.3fms p99=%.3fms max=%.3fms",
+                                stats.frames, stats.min_ms, stats.avg_ms,
+                                stats.p50_ms, stats.p99_ms, stats.max_ms));
+    for (size_t i = 0; i < FRAME_PHASE_COUNT; ++i) {
+      const auto phase = static_cast<FramePhase>(i);
+      const auto phase_stats = FrameProfiler::phaseStats(phase);
+      Logger::log(LogLevel::INFO,
+                  absl::StrFormat("  %-10s avg=%.3fms p50=%.3fms p99=%.3fms "
+                                  "max=%.3fms",
+                                  framePhaseName(phase), phase_stats.avg_ms,
+                                  phase_stats.p50_ms, phase_stats.p99_ms,
+                                  phase_stats.max_ms));
+    }
+    const auto draw_counts = FrameProfiler::drawCounts();
+    Logger::log(LogLevel::INFO,
+                absl::StrFormat("  last frame drawn=%d culled=%d cached=%d",
+                                draw_counts.drawn, draw_counts.culled,
+                                draw_counts.cached));
+    const auto cache_stats = TextureCache::stats();
+    Logger::log(LogLevel::INFO,
+                absl::StrFormat("  texture cache entries=%d bytes=%d "
+                                "referenced=%d hits=%d misses=%d evictions=%d",
+                                cache_stats.entries, cache_stats.bytes,
+                                cache_stats.referenced_bytes, cache_stats.hits,
+                                cache_stats.misses, cache_stats.evictions));
+    for (const auto& scene_stats : dispatcher_->sceneResidencyStats()) {
+      Logger::log(LogLevel::INFO,
+                  absl::StrFormat("  scene %s bytes=%d resident=%d "
+                                  "last_visit=%d evicted=%d",
+                                  scene_stats.name, scene_stats.bytes,
+                                  scene_stats.resident, scene_stats.last_visit,
+                                  scene_stats.evicted_bytes));
+    }
+  }
+}
+
+template <class SceneState>
+FrameTimeStats Engine<SceneState>::frameTimeStats() const {
+  assert(dispatcher_ != nullptr);
+  return dispatcher_->frameTimeStats();
+}
+
+template <class SceneState>
+std::vector<SceneResidencyStats> Engine<SceneState>::sceneResidencyStats()
+    const {
+  assert(dispatcher_ != nullptr);
+  return dispatcher_->sceneResidencyStats();
 }
 
 }  // namespace Truffle
@@ -9,10 +9,14 @@
 #ifndef TRUFFLE_ENGINE_CONFIG_H
 #define TRUFFLE_ENGINE_CONFIG_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "wrapper/sdl2/color.h"
+#include "wrapper/sdl2/texture_cache.h"
 
 namespace Truffle {
 
@@ -23,6 +27,51 @@ struct EngineConfig {
   Color renderer_color{0xff, 0xff, 0xff, 0xff};
   std::vector<std::pair<std::string, std::string>> font_paths;
   bool debug_fps = false;
+  // 1秒あたりの固定シミュレーションステップ数
+  uint32_t tick_rate = 60;
+  // 描画が遅延した際に1フレームで追いつくために実行する固定ステップの最大数
+  uint32_t max_catchup_ticks = 5;
+  // 並行実行を宣言したコントローラーの tick()/fixedUpdate() をワーカースレッドで実行する
+  bool parallel_update = false;
+  // 並行実行に用いるワーカースレッド数。0であればハードウェアスレッド数に合わせる
+  uint32_t update_worker_threads = 0;
+  // シミュレーションを専用スレッドで1フレーム先行して実行し、描画と並行させる。
+  // 有効な場合、コントローラーとイベントハンドラーはシミュレーションスレッドから呼ばれるため、
+  // テクスチャの生成を含むSDLの呼び出しを行ってはならない
+  bool pipelined_render = false;
+  // ウィンドウを表示せず、SDLのダミービデオドライバとソフトウェアレンダラーで実行する。
+  // 仮想時計で headless_frames フレームを実行した後、フレーム時間の統計を出力して終了する
+  bool headless = false;
+  uint32_t headless_frames = 600;
+  // ヘッドレスモードで1フレーム毎に進める仮想時計の頻度(Hz)
+  uint32_t headless_frame_rate = 60;
+  // TRUFFLE_ENABLE_TRACEでビルドした時、終了時にChrome trace形式で書き出す先
+  std::string trace_output_path;
+  // 指定されていれば、入力イベントとフレーム毎の経過時間をこのファイルに記録する
+  std::string input_record_path;
+  // 指定されていれば、実際の入力の代わりに記録されたイベントを再生し、
+  // 記録の終端で終了する
+  std::string input_replay_path;
+  // 描画内容が変わった範囲のみを再描画する。画面の大部分が静止している場合に有効
+  bool damage_tracking = false;
+  // 起動時にマウントするアセットパックのパス。truffle_pack で作成する。
+  // パックに含まれる画像は展開せずに読み込む
+  std::vector<std::string> asset_pack_paths;
+  // 起動時にテクスチャアトラスに詰め込む画像のパス
+  std::vector<std::string> atlas_image_paths;
+  // 参照されていない画像のテクスチャを保持するメモリ予算(バイト)。超えると
+  // 最も長く使われていないものから破棄する
+  size_t texture_cache_budget = TextureCache::DEFAULT_BUDGET;
+  // 非同期に読み込んだ画像のテクスチャを1フレームで生成する時間の予算(ミリ秒)。
+  // 少なくとも1枚は生成する
+  double texture_upload_budget_ms = 2.0;
+  // 現在のシーンから遷移できるシーンが TruffleScene::preloadImage() で宣言した
+  // 画像を先読みして保持するメモリ予算(バイト)。0であれば先読みしない
+  size_t scene_preload_budget = 64 * 1024 * 1024;
+  // 各シーンのオブジェクトが参照するテクスチャの合計の予算(バイト)。超えると最も長く
+  // アクティブになっていないシーンのテクスチャを解放し、再びアクティブになった時に読み込み
+  // 直す。0であれば解放しない
+  size_t scene_residency_budget = 0;
 };
 
 }  // namespace Truffle
@@ -12,11 +12,63 @@
 #include <SDL2/SDL.h>
 #include <stdint.h>
 
-#include <functional>
+#include "common/inplace_function.h"
 
 namespace Truffle {
 
-using CustomEventCallback = std::function<void(SDL_Event&)>;
+using CustomEventCallback = InplaceFunction<void(SDL_Event&)>;
+
+/**
+ * イベントハンドラーが関心を持つイベント種別の範囲。[first, last] の閉区間で表す。
+ */
+struct EventMask {
+  uint32_t first;
+  uint32_t last;
+
+  /**
+   * すべてのイベントを対象とするマスク
+   */
+  static constexpr EventMask all() { return EventMask{0, SDL_LASTEVENT}; }
+
+  /**
+   * 単一のイベント種別を対象とするマスク
+   * @param type SDL_MOUSEMOTION などのイベント種別
+   */
+  static constexpr EventMask of(uint32_t type) { return EventMask{type, type}; }
+
+  /**
+   * 連続したイベント種別を対象とするマスク
+   * @param first 範囲の先頭 (SDL_KEYDOWN など)
+   * @param last 範囲の末尾 (SDL_KEYUP など)
+   */
+  static constexpr EventMask range(uint32_t first, uint32_t last) {
+    return EventMask{first, last};
+  }
+
+  [[nodiscard]] constexpr bool contains(uint32_t type) const {
+    return first <= type && type <= last;
+  }
+
+  [[nodiscard]] constexpr uint32_t width() const { return last - first + 1; }
+};
+
+/**
+ * イベントハンドラーの登録を識別するハンドル。登録解除に用いる。
+ */
+struct EventCallbackHandle {
+  uint32_t id = 0;
+};
+
+/**
+ * イベントマスクとイベントハンドラーの組
+ */
+struct EventHandler {
+  EventMask mask;
+  uint32_t id;
+  CustomEventCallback callback;
+  // 登録解除済みか。配送中に解除された場合、callback は配送が終わるまで破棄しない
+  bool removed = false;
+};
 
 /**
  * シーンの変更イベントを識別するためのコード
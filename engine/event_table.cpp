@@ -0,0 +1,87 @@
+/**
+ * @file      event_table.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Event type indexed table of object event handlers
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "event_table.h"
+
+namespace Truffle {
+
+void EventDispatchTable::build(const TruffleScene& scene) {
+  indexed_.clear();
+  wildcard_.clear();
+
+  for (const auto& [_, controller] : scene.controllers()) {
+    for (auto& [_, object] : controller.get().visibleObjects()) {
+      insertAll(object.get().eventCallbackRegistry());
+    }
+    for (auto& [_, object] : controller.get().invisibleObjects()) {
+      insertAll(object.get().eventCallbackRegistry());
+    }
+  }
+}
+
+void EventDispatchTable::insertAll(EventCallbackRegistry& registry) {
+  // 索引を作り直すこの時点でのみ墓標を取り除くことができる
+  registry.compact();
+  const auto handlers = registry.handlers();
+  for (uint32_t i = 0; i < handlers.size(); ++i) {
+    insert(Slot{&registry, i, handlers[i].mask});
+  }
+}
+
+void EventDispatchTable::insert(const Slot& slot) {
+  if (slot.mask.width() > MAX_INDEXED_MASK_WIDTH) {
+    // ワイルドカードは既に索引された種別と、まだ索引されていない種別の両方に配送する
+    wildcard_.emplace_back(slot);
+    for (auto& [type, slots] : indexed_) {
+      if (slot.mask.contains(type)) {
+        slots.emplace_back(slot);
+      }
+    }
+    return;
+  }
+
+  for (uint32_t type = slot.mask.first; type <= slot.mask.last; ++type) {
+    auto it = indexed_.find(type);
+    if (it == indexed_.end()) {
+      // 新しく索引する種別には、それまでに登録されたワイルドカードを引き継ぐ
+      it = indexed_.emplace(type, std::vector<Slot>()).first;
+      for (const auto& wildcard : wildcard_) {
+        if (wildcard.mask.contains(type)) {
+          it->second.emplace_back(wildcard);
+        }
+      }
+    }
+    it->second.emplace_back(slot);
+  }
+}
+
+void EventDispatchTable::dispatch(Event& e) const {
+  auto invoke = [&e](const Slot& slot) {
+    // 配送中に解除されたハンドラーは読み飛ばす
+    const auto& handler = slot.registry->handlers()[slot.index];
+    if (!handler.removed && handler.callback) {
+      EventCallbackRegistry::DispatchScope scope(*slot.registry);
+      handler.callback(e);
+    }
+  };
+
+  auto it = indexed_.find(e.type);
+  if (it == indexed_.end()) {
+    for (const auto& slot : wildcard_) {
+      if (slot.mask.contains(e.type)) {
+        invoke(slot);
+      }
+    }
+    return;
+  }
+  for (const auto& slot : it->second) {
+    invoke(slot);
+  }
+}
+
+}  // namespace Truffle
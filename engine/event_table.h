@@ -0,0 +1,64 @@
+/**
+ * @file      event_table.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Event type indexed table of object event handlers
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_EVENT_TABLE_H
+#define TRUFFLE_EVENT_TABLE_H
+
+#include <absl/container/flat_hash_map.h>
+
+#include <vector>
+
+#include "event.h"
+#include "scene.h"
+#include "wrapper/sdl2/event.h"
+
+namespace Truffle {
+
+/**
+ * シーン内のオブジェクトが登録したイベントハンドラーをイベント種別毎に索引するテーブル。
+ * イベントはそのイベント種別に関心を持つハンドラーにのみ配送される。
+ */
+class EventDispatchTable {
+ public:
+  // これより広い範囲のマスクは種別毎に索引せず、ワイルドカードとして扱う
+  static constexpr uint32_t MAX_INDEXED_MASK_WIDTH = 64;
+
+  /**
+   * シーンに属するすべてのオブジェクトのハンドラーからテーブルを再構築する
+   * @param scene
+   */
+  void build(const TruffleScene& scene);
+
+  /**
+   * イベントを関心を持つハンドラーに配送する
+   * @param e
+   */
+  void dispatch(Event& e) const;
+
+ private:
+  /**
+   * ハンドラーの所在。ハンドラーの追加で領域が再確保されても有効であるよう、
+   * ポインタではなくレジストリとインデックスで保持する。
+   */
+  struct Slot {
+    EventCallbackRegistry* registry;
+    uint32_t index;
+    EventMask mask;
+  };
+
+  void insertAll(EventCallbackRegistry& registry);
+  void insert(const Slot& slot);
+
+  absl::flat_hash_map<uint32_t, std::vector<Slot>> indexed_;
+  // 種別毎に索引されないハンドラー。索引済みの種別のリストにも含まれる
+  std::vector<Slot> wildcard_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_EVENT_TABLE_H
@@ -0,0 +1,73 @@
+/**
+ * @file      frame_context.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Per-frame information passed to controllers
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_FRAME_CONTEXT_H
+#define TRUFFLE_FRAME_CONTEXT_H
+
+#include <SDL2/SDL.h>
+
+#include <bitset>
+#include <cstdint>
+
+namespace Truffle {
+
+/**
+ * そのフレームで処理するイベントをすべて反映した入力状態と、前フレームからの変化。
+ * 同じフレームのすべてのハンドラーとコントローラーから同じ状態が見える。
+ */
+struct InputSnapshot {
+  using KeySet = std::bitset<SDL_NUM_SCANCODES>;
+
+  int mouse_x = 0;
+  int mouse_y = 0;
+  // SDL_BUTTON() で表現されるマウスボタンの押下状態
+  uint32_t mouse_buttons = 0;
+  // このフレームで押された・離されたマウスボタン
+  uint32_t mouse_pressed = 0;
+  uint32_t mouse_released = 0;
+  // スキャンコード毎の押下状態
+  KeySet keys;
+  // このフレームで押された・離されたキー。キーリピートは含まない
+  KeySet keys_pressed;
+  KeySet keys_released;
+
+  [[nodiscard]] bool mouseDown(uint8_t button) const {
+    return (mouse_buttons & SDL_BUTTON(button)) != 0;
+  }
+  [[nodiscard]] bool mousePressed(uint8_t button) const {
+    return (mouse_pressed & SDL_BUTTON(button)) != 0;
+  }
+  [[nodiscard]] bool mouseReleased(uint8_t button) const {
+    return (mouse_released & SDL_BUTTON(button)) != 0;
+  }
+
+  [[nodiscard]] bool keyDown(SDL_Scancode scancode) const {
+    return scancode < SDL_NUM_SCANCODES && keys.test(scancode);
+  }
+  [[nodiscard]] bool keyPressed(SDL_Scancode scancode) const {
+    return scancode < SDL_NUM_SCANCODES && keys_pressed.test(scancode);
+  }
+  [[nodiscard]] bool keyReleased(SDL_Scancode scancode) const {
+    return scancode < SDL_NUM_SCANCODES && keys_released.test(scancode);
+  }
+};
+
+/**
+ * 1フレームに1度だけ TruffleController::tick に渡されるフレーム情報
+ */
+struct FrameContext {
+  // 前フレームからの経過時間(秒)
+  double delta_time = 0;
+  // 起動してからのフレーム数
+  uint64_t frame = 0;
+  InputSnapshot input;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_FRAME_CONTEXT_H
@@ -0,0 +1,80 @@
+/**
+ * @file      frame_pipeline.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Run simulation on a dedicated thread, one frame ahead of rendering
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "frame_pipeline.h"
+
+#include <utility>
+
+#include "common/exception.h"
+
+namespace Truffle {
+
+FramePipeline::FramePipeline(Stage simulate)
+    : simulate_(std::move(simulate)), thread_([this] { loop(); }) {}
+
+FramePipeline::~FramePipeline() {
+  {
+    std::unique_lock<std::mutex> l(mux_);
+    cv_.wait(l, [this] { return state_ != State::Running; });
+    state_ = State::Stop;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void FramePipeline::kick(std::vector<Event>& events) {
+  {
+    std::unique_lock<std::mutex> l(mux_);
+    if (state_ != State::Idle) {
+      throw TruffleException("FramePipeline::kick called before wait");
+    }
+    events_.swap(events);
+    state_ = State::Running;
+  }
+  cv_.notify_all();
+}
+
+const RenderCommandList& FramePipeline::wait() {
+  std::unique_lock<std::mutex> l(mux_);
+  cv_.wait(l, [this] { return state_ == State::Done; });
+  state_ = State::Idle;
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+  // 記録が終わったリストを表に回し、次のフレームは他方に記録する
+  const auto& front = lists_[back_];
+  back_ = 1 - back_;
+  return front;
+}
+
+void FramePipeline::loop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> l(mux_);
+      cv_.wait(l, [this] {
+        return state_ == State::Running || state_ == State::Stop;
+      });
+      if (state_ == State::Stop) {
+        return;
+      }
+    }
+    try {
+      simulate_(events_, lists_[back_]);
+    } catch (...) {
+      std::unique_lock<std::mutex> l(mux_);
+      error_ = std::current_exception();
+    }
+    {
+      std::unique_lock<std::mutex> l(mux_);
+      state_ = State::Done;
+    }
+    cv_.notify_all();
+  }
+}
+
+}  // namespace Truffle
@@ -0,0 +1,76 @@
+/**
+ * @file      frame_pipeline.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Run simulation on a dedicated thread, one frame ahead of rendering
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_FRAME_PIPELINE_H
+#define TRUFFLE_FRAME_PIPELINE_H
+
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/non_copyable.h"
+#include "render_command.h"
+#include "wrapper/sdl2/event.h"
+
+namespace Truffle {
+
+/**
+ * シミュレーションを専用のスレッドで実行し、描画命令をダブルバッファリングするクラス。
+ * メインスレッドがフレームNを描画している間に、シミュレーションスレッドはフレームN+1を
+ * 計算して描画命令を記録する。
+ */
+class FramePipeline : NonCopyable {
+ public:
+  using Stage = std::function<void(std::vector<Event>&, RenderCommandList&)>;
+
+  /**
+   * @param simulate シミュレーションスレッドで実行する処理。受け取ったイベントを処理し、
+   * 描画命令を記録する。
+   */
+  explicit FramePipeline(Stage simulate);
+  ~FramePipeline();
+
+  /**
+   * 次のフレームのシミュレーションを開始する。eventsの中身はパイプラインが
+   * 保持していたバッファと交換される。
+   * @param events このフレームで処理するイベント
+   */
+  void kick(std::vector<Event>& events);
+
+  /**
+   * シミュレーションの完了を待ち、記録された描画命令を返す。返されたリストは
+   * 次に wait() を呼ぶまで有効であり、その間シミュレーションは他方のリストに記録する。
+   * シミュレーションが例外を送出していた場合は再送出する。
+   * @return
+   */
+  const RenderCommandList& wait();
+
+ private:
+  enum class State { Idle, Running, Done, Stop };
+
+  void loop();
+
+  Stage simulate_;
+  std::array<RenderCommandList, 2> lists_;
+  size_t back_ = 0;
+  std::vector<Event> events_;
+
+  std::mutex mux_;
+  std::condition_variable cv_;
+  State state_ = State::Idle;
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_FRAME_PIPELINE_H
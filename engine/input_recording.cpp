@@ -0,0 +1,140 @@
+/**
+ * @file      input_recording.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Record and replay input event stream
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "input_recording.h"
+
+#include <absl/strings/str_format.h>
+
+#include <chrono>
+
+#include "common/exception.h"
+#include "event.h"
+
+namespace Truffle {
+
+namespace {
+
+template <class T>
+void writeValue(std::ofstream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool readValue(std::ifstream& in, T& value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+}  // namespace
+
+bool InputRecordingFormat::recordable(const Event& e) {
+  if (e.user.type == EV_SCENE_CHANGED) {
+    return false;
+  }
+  // アプリケーション定義のイベントは data1/data2 にポインタを持ちうる
+  if (e.type >= SDL_USEREVENT) {
+    return false;
+  }
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+  // 長い変換中の文字列はヒープに確保される
+  if (e.type == SDL_TEXTEDITING_EXT) {
+    return false;
+  }
+#endif
+  return e.type != SDL_DROPFILE && e.type != SDL_DROPTEXT;
+}
+
+InputRecorder::InputRecorder(const std::string& path)
+    : path_(path), out_(path, std::ios::binary | std::ios::trunc) {
+  if (!out_) {
+    throw TruffleException(
+        absl::StrFormat("Failed to open input recording %s", path));
+  }
+  out_.write(InputRecordingFormat::MAGIC.data(),
+             InputRecordingFormat::MAGIC.size());
+  writeValue(out_, InputRecordingFormat::VERSION);
+  writeValue(out_, static_cast<uint32_t>(sizeof(Event)));
+}
+
+void InputRecorder::writeFrame(uint64_t frame, SteadyClock::duration elapsed,
+                               absl::Span<const Event> events) {
+  recordable_.clear();
+  for (const auto& e : events) {
+    if (InputRecordingFormat::recordable(e)) {
+      recordable_.emplace_back(e);
+    }
+  }
+
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  writeValue(out_, frame);
+  writeValue(out_, elapsed_ns);
+  writeValue(out_, static_cast<uint32_t>(recordable_.size()));
+  out_.write(reinterpret_cast<const char*>(recordable_.data()),
+             static_cast<std::streamsize>(recordable_.size() * sizeof(Event)));
+  if (!out_) {
+    throw TruffleException(
+        absl::StrFormat("Failed to write input recording %s", path_));
+  }
+}
+
+InputReplayer::InputReplayer(const std::string& path)
+    : path_(path), in_(path, std::ios::binary) {
+  if (!in_) {
+    throw TruffleException(
+        absl::StrFormat("Failed to open input recording %s", path));
+  }
+  std::array<char, 4> magic{};
+  uint32_t version = 0;
+  uint32_t event_size = 0;
+  in_.read(magic.data(), magic.size());
+  if (!in_ || magic != InputRecordingFormat::MAGIC ||
+      !readValue(in_, version) || !readValue(in_, event_size)) {
+    throw TruffleException(
+        absl::StrFormat("%s is not an input recording", path));
+  }
+  if (version != InputRecordingFormat::VERSION ||
+      event_size != sizeof(Event)) {
+    throw TruffleException(absl::StrFormat(
+        "Input recording %s is incompatible: version=%d event_size=%d", path,
+        version, event_size));
+  }
+  const auto header_end = in_.tellg();
+  in_.seekg(0, std::ios::end);
+  file_size_ = in_.tellg();
+  in_.seekg(header_end);
+}
+
+bool InputReplayer::nextFrame(InputFrame& frame) {
+  int64_t elapsed_ns = 0;
+  uint32_t event_count = 0;
+  if (!readValue(in_, frame.frame)) {
+    return false;
+  }
+  if (!readValue(in_, elapsed_ns) || !readValue(in_, event_count)) {
+    throw TruffleException(absl::StrFormat(
+        "Input recording %s is truncated at frame %d", path_, frame.frame));
+  }
+  const auto remaining = file_size_ - in_.tellg();
+  if (static_cast<uint64_t>(event_count) * sizeof(Event) >
+      static_cast<uint64_t>(remaining)) {
+    throw TruffleException(absl::StrFormat(
+        "Input recording %s is truncated at frame %d", path_, frame.frame));
+  }
+  frame.elapsed = std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::nanoseconds(elapsed_ns));
+  frame.events.resize(event_count);
+  in_.read(reinterpret_cast<char*>(frame.events.data()),
+           static_cast<std::streamsize>(event_count * sizeof(Event)));
+  if (!in_) {
+    throw TruffleException(absl::StrFormat(
+        "Input recording %s is truncated at frame %d", path_, frame.frame));
+  }
+  return true;
+}
+
+}  // namespace Truffle
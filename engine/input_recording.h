@@ -0,0 +1,113 @@
+/**
+ * @file      input_recording.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Record and replay input event stream
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_INPUT_RECORDING_H
+#define TRUFFLE_INPUT_RECORDING_H
+
+#include <SDL2/SDL.h>
+#include <absl/types/span.h>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "common/non_copyable.h"
+#include "metrics.h"
+#include "wrapper/sdl2/event.h"
+
+namespace Truffle {
+
+/**
+ * 記録ファイルの1フレーム分のレコード
+ */
+struct InputFrame {
+  // 記録時のフレーム番号
+  uint64_t frame = 0;
+  // 記録時にシミュレーションに与えられた前フレームからの経過時間
+  SteadyClock::duration elapsed{};
+  std::vector<Event> events;
+};
+
+/**
+ * 入力イベントの記録ファイルの形式
+ *
+ * ヘッダー: magic(4byte) version(u32) sizeof(SDL_Event)(u32)
+ * フレーム: frame(u64) elapsed_ns(i64) event_count(u32) SDL_Event * event_count
+ *
+ * 値は記録したマシンのバイトオーダーで書き出す。SDL_Event をそのまま書き出すので、
+ * 同じSDLのバージョンでビルドしたエンジン同士でのみ再生できる。
+ */
+struct InputRecordingFormat {
+  static constexpr std::array<char, 4> MAGIC = {'T', 'R', 'I', 'R'};
+  static constexpr uint32_t VERSION = 1;
+
+  /**
+   * 記録の対象となるイベントか。エンジン内部で発行されるシーン遷移のイベントは
+   * 再生時にもエンジンが発行するので記録しない。ポインタを含みうるイベント
+   * (ドロップ、SDL_TEXTEDITING_EXT、SDL_USEREVENT 以降の種別)も記録しない。
+   * @param e
+   * @return
+   */
+  static bool recordable(const Event& e);
+};
+
+/**
+ * 1フレーム毎にシミュレーションに与えられたイベントと経過時間を書き出すクラス
+ */
+class InputRecorder : NonCopyable {
+ public:
+  /**
+   * @param path 書き出し先。既存のファイルは上書きされる。
+   */
+  explicit InputRecorder(const std::string& path);
+
+  /**
+   * 1フレーム分のイベントを書き出す。記録の対象でないイベントは読み飛ばす。
+   * @param frame フレーム番号
+   * @param elapsed シミュレーションに与えた前フレームからの経過時間
+   * @param events このフレームで処理したイベント
+   */
+  void writeFrame(uint64_t frame, SteadyClock::duration elapsed,
+                  absl::Span<const Event> events);
+
+ private:
+  std::string path_;
+  std::ofstream out_;
+  std::vector<Event> recordable_;
+};
+
+/**
+ * 記録されたイベントを1フレームずつ読み出すクラス。入力状態はイベントから
+ * InputService が再構築する。
+ */
+class InputReplayer : NonCopyable {
+ public:
+  /**
+   * @param path 記録ファイル。形式が一致しなければ例外を送出する。
+   */
+  explicit InputReplayer(const std::string& path);
+
+  /**
+   * 次のフレームを読み出す
+   * @param frame 読み出し先
+   * @return 記録の終端に達していればfalse
+   */
+  bool nextFrame(InputFrame& frame);
+
+ private:
+  std::string path_;
+  std::ifstream in_;
+  // 壊れたイベント数で過大な確保をしないよう、残りの大きさと比べるのに使う
+  std::streamoff file_size_ = 0;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_INPUT_RECORDING_H
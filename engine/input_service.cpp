@@ -0,0 +1,63 @@
+/**
+ * @file      input_service.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Per-frame input state built from the frame's events
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "input_service.h"
+
+namespace Truffle {
+
+void InputService::advance_(absl::Span<const Event> events) {
+  snapshot_.mouse_pressed = 0;
+  snapshot_.mouse_released = 0;
+  snapshot_.keys_pressed.reset();
+  snapshot_.keys_released.reset();
+  for (const auto& e : events) {
+    apply(e);
+  }
+}
+
+void InputService::apply(const Event& e) {
+  auto& input = snapshot_;
+  switch (e.type) {
+    case SDL_MOUSEMOTION:
+      input.mouse_x = e.motion.x;
+      input.mouse_y = e.motion.y;
+      input.mouse_buttons = e.motion.state;
+      break;
+    case SDL_MOUSEBUTTONDOWN:
+      input.mouse_x = e.button.x;
+      input.mouse_y = e.button.y;
+      input.mouse_buttons |= SDL_BUTTON(e.button.button);
+      input.mouse_pressed |= SDL_BUTTON(e.button.button);
+      break;
+    case SDL_MOUSEBUTTONUP:
+      input.mouse_x = e.button.x;
+      input.mouse_y = e.button.y;
+      input.mouse_buttons &= ~SDL_BUTTON(e.button.button);
+      input.mouse_released |= SDL_BUTTON(e.button.button);
+      break;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP: {
+      const auto scancode = static_cast<size_t>(e.key.keysym.scancode);
+      if (scancode >= input.keys.size()) {
+        break;
+      }
+      const bool down = e.key.state == SDL_PRESSED;
+      input.keys.set(scancode, down);
+      if (down && e.key.repeat == 0) {
+        input.keys_pressed.set(scancode);
+      } else if (!down) {
+        input.keys_released.set(scancode);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+}  // namespace Truffle
@@ -0,0 +1,59 @@
+/**
+ * @file      input_service.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Per-frame input state built from the frame's events
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_INPUT_SERVICE_H
+#define TRUFFLE_INPUT_SERVICE_H
+
+#include <SDL2/SDL.h>
+#include <absl/types/span.h>
+
+#include "common/non_copyable.h"
+#include "common/singleton.h"
+#include "frame_context.h"
+#include "wrapper/sdl2/event.h"
+
+namespace Truffle {
+
+/**
+ * フレーム毎の入力状態を提供するクラス。Dispatcherがフレームの開始時にそのフレームの
+ * イベントから1度だけ状態を更新するので、オブジェクトやコントローラーはSDLに問い合わせずに
+ * 同じ入力状態を参照できる。イベントから状態を求めるため、記録した入力の再生時も
+ * 同じ状態が再現される。シミュレーションスレッドから使うこと。
+ */
+class InputService : public MutableSingleton<InputService>, NonCopyable {
+ public:
+  /**
+   * 現在のフレームの入力状態を返す
+   * @return
+   */
+  static const InputSnapshot& snapshot() {
+    return InputService::get().snapshot_;
+  }
+
+  /**
+   * 前フレームの状態にイベントを反映し、押下と解放の変化を求め直す
+   * @param events そのフレームで処理するイベント
+   */
+  static void advance(absl::Span<const Event> events) {
+    InputService::get().advance_(events);
+  }
+
+ private:
+  friend class MutableSingleton<InputService>;
+
+  InputService() = default;
+
+  void advance_(absl::Span<const Event> events);
+  void apply(const Event& e);
+
+  InputSnapshot snapshot_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_INPUT_SERVICE_H
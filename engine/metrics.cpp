@@ -7,3 +7,83 @@
  */
 
 #include "metrics.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Truffle {
+
+FrameTimeStats FrameTimeStats::compute(std::vector<double> samples_ms) {
+  FrameTimeStats stats;
+  if (samples_ms.empty()) {
+    return stats;
+  }
+  std::sort(samples_ms.begin(), samples_ms.end());
+  auto percentile = [&samples_ms](double p) {
+    const auto rank = static_cast<size_t>(p * (samples_ms.size() - 1) + 0.5);
+    return samples_ms[rank];
+  };
+  stats.frames = samples_ms.size();
+  stats.min_ms = samples_ms.front();
+  stats.max_ms = samples_ms.back();
+  stats.avg_ms = std::accumulate(samples_ms.begin(), samples_ms.end(), 0.0) /
+                 samples_ms.size();
+  stats.p50_ms = percentile(0.50);
+  stats.p99_ms = percentile(0.99);
+  return stats;
+}
+
+const char* framePhaseName(FramePhase phase) {
+  switch (phase) {
+    case FramePhase::EventPoll:
+      return "event_poll";
+    case FramePhase::Callbacks:
+      return "callbacks";
+    case FramePhase::Update:
+      return "update";
+    case FramePhase::Render:
+      return "render";
+    case FramePhase::Present:
+      return "present";
+  }
+  return "unknown";
+}
+
+void FrameProfiler::addPhaseTime_(FramePhase phase,
+                                  SteadyClock::duration elapsed) {
+  std::unique_lock<std::mutex> l(mux_);
+  pending_ms_[static_cast<size_t>(phase)] +=
+      std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+void FrameProfiler::commitFrame_(SteadyClock::duration frame_time,
+                                 const FramePhaseTimes& recorded) {
+  std::unique_lock<std::mutex> l(mux_);
+  for (size_t i = 0; i < FRAME_PHASE_COUNT; ++i) {
+    phases_[i].push(pending_ms_[i] + recorded[i]);
+    pending_ms_[i] = 0;
+  }
+  frames_.push(std::chrono::duration<double, std::milli>(frame_time).count());
+}
+
+FrameTimeStats FrameProfiler::phaseStats_(FramePhase phase) {
+  std::unique_lock<std::mutex> l(mux_);
+  return phases_[static_cast<size_t>(phase)].stats();
+}
+
+FrameTimeStats FrameProfiler::frameStats_() {
+  std::unique_lock<std::mutex> l(mux_);
+  return frames_.stats();
+}
+
+void FrameProfiler::setDrawCounts_(DrawCounts counts) {
+  std::unique_lock<std::mutex> l(mux_);
+  draw_counts_ = counts;
+}
+
+DrawCounts FrameProfiler::drawCounts_() {
+  std::unique_lock<std::mutex> l(mux_);
+  return draw_counts_;
+}
+
+}  // namespace Truffle
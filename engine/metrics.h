@@ -9,10 +9,13 @@
 #ifndef TRUFFLE_METRICS_H
 #define TRUFFLE_METRICS_H
 
+#include <algorithm>
+#include <array>
 #include <chrono>
-#include <iostream>
+#include <mutex>
+#include <vector>
 
-#include "common/logger.h"
+#include "common/non_copyable.h"
 #include "common/singleton.h"
 
 namespace Truffle {
@@ -20,50 +23,203 @@ namespace Truffle {
 using SteadyClock = std::chrono::steady_clock;
 using SteadyClockTimePoint = SteadyClock::time_point;
 
-class FpsMetrics : public MutableSingleton<FpsMetrics> {
- public:
-  static void incFrame() { FpsMetrics::get().incFrame_(); }
+/**
+ * フレーム時間の統計。単位はミリ秒。
+ */
+struct FrameTimeStats {
+  uint64_t frames = 0;
+  double min_ms = 0;
+  double avg_ms = 0;
+  double p50_ms = 0;
+  double p99_ms = 0;
+  double max_ms = 0;
+
+  /**
+   * サンプルから統計を計算する
+   * @param samples_ms フレーム時間のサンプル(ミリ秒)
+   * @return
+   */
+  static FrameTimeStats compute(std::vector<double> samples_ms);
+};
+
+/**
+ * ディスパッチャーの1フレームを構成するフェーズ
+ */
+enum class FramePhase {
+  // SDLのイベントキューからの取り出し
+  EventPoll,
+  // コントローラーとオブジェクトへのイベントの配送
+  Callbacks,
+  // fixedUpdate() と tick()
+  Update,
+  // 描画命令の記録と実行
+  Render,
+  // SDL_RenderPresent
+  Present,
+};
 
-  static bool shouldCalcFps() { return FpsMetrics::get().shouldCalcFps_(); }
+static constexpr size_t FRAME_PHASE_COUNT = 5;
 
-  static double fps() { return FpsMetrics::get().fps_(); }
+/**
+ * フェーズ毎の所要時間(ミリ秒)
+ */
+using FramePhaseTimes = std::array<double, FRAME_PHASE_COUNT>;
+
+/**
+ * フェーズの表示名を返す
+ * @param phase
+ * @return
+ */
+const char* framePhaseName(FramePhase phase);
+
+/**
+ * 1フレームで描画したオブジェクトと画面外として省いたオブジェクト、
+ * 静的な層のキャッシュから合成したオブジェクトの数
+ */
+struct DrawCounts {
+  uint32_t drawn = 0;
+  uint32_t culled = 0;
+  uint32_t cached = 0;
+};
+
+/**
+ * 直近N個のサンプルを保持する固定長のリングバッファ
+ * @tparam N
+ */
+template <size_t N>
+class SampleRing {
+ public:
+  void push(double sample) {
+    samples_[head_] = sample;
+    head_ = (head_ + 1) % N;
+    size_ = std::min(size_ + 1, N);
+  }
+
+  [[nodiscard]] FrameTimeStats stats() const {
+    return FrameTimeStats::compute(
+        std::vector<double>(samples_.begin(), samples_.begin() + size_));
+  }
 
  private:
-  friend class MutableSingleton<FpsMetrics>;
+  std::array<double, N> samples_{};
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
 
-  // Ensure that this constructor called at startup time.
-  explicit FpsMetrics() : start_time_(SteadyClock::now()) {}
+/**
+ * フェーズ毎のフレーム時間を直近 WINDOW_FRAMES フレーム分保持し、統計を提供するクラス。
+ * パイプライン実行時は描画命令の記録と表示が別のフレームで行われるので、記録側の
+ * フェーズは描画命令と共に受け渡し、それを表示したフレームとして確定する。
+ */
+class FrameProfiler : public MutableSingleton<FrameProfiler> {
+ public:
+  static constexpr size_t WINDOW_FRAMES = 240;
+
+  /**
+   * 現在のフレームにフェーズの所要時間を加算する
+   * @param phase
+   * @param elapsed
+   */
+  static void addPhaseTime(FramePhase phase, SteadyClock::duration elapsed) {
+    FrameProfiler::get().addPhaseTime_(phase, elapsed);
+  }
 
-  void incFrame_() {
-    if (std::numeric_limits<uint64_t>::max() < frame_) {
-      start_time_ = SteadyClock::now();
-      frame_ = 1;
-    } else {
-      ++frame_;
-    }
-    ++calc_per_frames_;
+  /**
+   * 現在のフレームを確定し、次のフレームの計測を開始する
+   * @param frame_time 前フレームの表示からこのフレームの表示までの時間
+   * @param recorded 表示した描画命令を記録した際に計測したフェーズの所要時間
+   */
+  static void commitFrame(SteadyClock::duration frame_time,
+                          const FramePhaseTimes& recorded = {}) {
+    FrameProfiler::get().commitFrame_(frame_time, recorded);
   }
 
-  // TODO(shikugawa): It should be provided with DispatcherMetricsDriver class
-  bool shouldCalcFps_() {
-    bool result = calc_per_frames_ == default_calc_per_frames_;
-    if (result) {
-      calc_per_frames_ = 1;
-    }
-    return result;
+  /**
+   * フェーズの所要時間の統計を返す
+   * @param phase
+   * @return
+   */
+  static FrameTimeStats phaseStats(FramePhase phase) {
+    return FrameProfiler::get().phaseStats_(phase);
+  }
+
+  /**
+   * フレーム時間の統計を返す
+   * @return
+   */
+  static FrameTimeStats frameStats() {
+    return FrameProfiler::get().frameStats_();
+  }
+
+  /**
+   * 描画リストを走査したフレームの描画数と省略数を記録する
+   * @param counts
+   */
+  static void setDrawCounts(DrawCounts counts) {
+    FrameProfiler::get().setDrawCounts_(counts);
   }
 
-  double fps_() {
-    auto current_time = SteadyClock::now().time_since_epoch();
-    return frame_ / std::chrono::duration_cast<std::chrono::seconds>(
-                        current_time - start_time_.time_since_epoch())
-                        .count();
+  /**
+   * 直近に記録されたフレームの描画数と省略数を返す
+   * @return
+   */
+  static DrawCounts drawCounts() { return FrameProfiler::get().drawCounts_(); }
+
+  /**
+   * 直近のフレーム時間の平均から求めたFPSを返す。計測前は0を返す。
+   * @return
+   */
+  static double fps() {
+    const auto stats = frameStats();
+    return stats.avg_ms > 0 ? 1000.0 / stats.avg_ms : 0;
   }
 
-  SteadyClockTimePoint start_time_;
-  uint64_t frame_ = 0;
-  uint64_t calc_per_frames_ = 1;
-  const uint64_t default_calc_per_frames_ = 100;
+ private:
+  friend class MutableSingleton<FrameProfiler>;
+
+  FrameProfiler() = default;
+
+  void addPhaseTime_(FramePhase phase, SteadyClock::duration elapsed);
+  void commitFrame_(SteadyClock::duration frame_time,
+                    const FramePhaseTimes& recorded);
+  FrameTimeStats phaseStats_(FramePhase phase);
+  FrameTimeStats frameStats_();
+  void setDrawCounts_(DrawCounts counts);
+  DrawCounts drawCounts_();
+
+  std::mutex mux_;
+  FramePhaseTimes pending_ms_{};
+  std::array<SampleRing<WINDOW_FRAMES>, FRAME_PHASE_COUNT> phases_;
+  SampleRing<WINDOW_FRAMES> frames_;
+  DrawCounts draw_counts_;
+};
+
+/**
+ * スコープの開始から終了までをフェーズの所要時間として記録する
+ */
+class ScopedPhaseTimer : NonCopyable {
+ public:
+  /**
+   * @param phase
+   * @param times 加算先。nullptrであれば FrameProfiler の現在のフレームに加算する
+   */
+  explicit ScopedPhaseTimer(FramePhase phase, FramePhaseTimes* times = nullptr)
+      : phase_(phase), times_(times), start_(SteadyClock::now()) {}
+
+  ~ScopedPhaseTimer() {
+    const auto elapsed = SteadyClock::now() - start_;
+    if (times_ == nullptr) {
+      FrameProfiler::addPhaseTime(phase_, elapsed);
+      return;
+    }
+    (*times_)[static_cast<size_t>(phase_)] +=
+        std::chrono::duration<double, std::milli>(elapsed).count();
+  }
+
+ private:
+  FramePhase phase_;
+  FramePhaseTimes* times_;
+  SteadyClockTimePoint start_;
 };
 
 }  // namespace Truffle
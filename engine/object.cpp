@@ -8,13 +8,116 @@
 
 #include "object.h"
 
+#include <algorithm>
+
+#include "render_command.h"
+
 namespace Truffle {
 
+EventCallbackHandle EventCallbackRegistry::add(EventMask mask,
+                                               CustomEventCallback callback) {
+  const auto id = next_id_++;
+  // 配送中に handlers_ を再確保すると実行中のハンドラーが破棄されるので後で加える
+  auto& handlers = dispatch_depth_ > 0 ? pending_ : handlers_;
+  handlers.emplace_back(EventHandler{mask, id, std::move(callback)});
+  SceneGraphRevision::bump();
+  return EventCallbackHandle{id};
+}
+
+void EventCallbackRegistry::remove(EventCallbackHandle handle) {
+  for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+    if (it->id == handle.id) {
+      pending_.erase(it);
+      return;
+    }
+  }
+  for (auto& handler : handlers_) {
+    if (handler.id == handle.id && !handler.removed) {
+      handler.removed = true;
+      // 実行中のハンドラー自身が解除することもあるので、配送中は破棄しない
+      if (dispatch_depth_ == 0) {
+        handler.callback = nullptr;
+      }
+      has_tombstone_ = true;
+      SceneGraphRevision::bump();
+      return;
+    }
+  }
+}
+
+void EventCallbackRegistry::compact() {
+  if (!has_tombstone_) {
+    return;
+  }
+  handlers_.erase(std::remove_if(handlers_.begin(), handlers_.end(),
+                                 [](const EventHandler& handler) {
+                                   return handler.removed;
+                                 }),
+                  handlers_.end());
+  has_tombstone_ = false;
+}
+
+void EventCallbackRegistry::flush() {
+  if (has_tombstone_) {
+    for (auto& handler : handlers_) {
+      if (handler.removed) {
+        handler.callback = nullptr;
+      }
+    }
+  }
+  // 末尾に加えるだけなので、索引済みのハンドラーのインデックスは変わらない
+  for (auto& handler : pending_) {
+    handlers_.emplace_back(std::move(handler));
+  }
+  pending_.clear();
+}
+
 TruffleVisibleObject::TruffleVisibleObject(std::string name) : name_(name) {}
 
+void TruffleVisibleObject::record(RenderCommandList& commands) {
+  commands.immediate(*this);
+}
+
 void TruffleVisibleObject::setPoint(int x, int y) {
   render_rect.x = x;
   render_rect.y = y;
+  invalidateBounds();
+}
+
+void TruffleVisibleObject::setLayer(int32_t layer) {
+  if (layer_ != layer) {
+    layer_ = layer;
+    invalidateDrawOrder();
+  }
+}
+
+void TruffleVisibleObject::setZ(int32_t z) {
+  if (z_ != z) {
+    z_ = z;
+    invalidateDrawOrder();
+  }
+}
+
+void TruffleVisibleObject::setInteractive(bool interactive) {
+  if (interactive_ != interactive) {
+    interactive_ = interactive;
+    SceneGraphRevision::bump();
+  }
+}
+
+void TruffleVisibleObject::invalidateDrawOrder() {
+  draw_order_dirty_ = true;
+  DrawOrderRevision::bump();
+}
+
+void TruffleVisibleObject::invalidateContent() {
+  content_dirty_ = true;
+  DrawOrderRevision::bump();
+}
+
+void TruffleVisibleObject::invalidateBounds() {
+  bounds_dirty_ = true;
+  DrawOrderRevision::bump();
 }
 
 TruffleInvisibleObject::TruffleInvisibleObject(std::string name)
@@ -10,15 +10,92 @@
 #define TRUFFLE_OBJECT_H
 
 #include <SDL2/SDL.h>
+#include <absl/types/span.h>
 
-#include <forward_list>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 #include "common/non_copyable.h"
 #include "event.h"
+#include "revision.h"
 
 namespace Truffle {
 
+class DrawList;
+class RenderCommandList;
+struct RenderContext;
+
+/**
+ * オブジェクトが所有するイベントハンドラーを連続領域に保持するクラス。
+ * 登録解除されたハンドラーは墓標として残し、イベントの配送中ではない時に compact()
+ * で詰める。これによりインデックスはイベントの配送中も有効であり続ける。
+ * 配送中のハンドラーからの登録と解除は、実行中のハンドラーを破棄しないよう
+ * 配送が終わるまで遅延する。
+ */
+class EventCallbackRegistry {
+ public:
+  /**
+   * このレジストリのハンドラーを呼び出している間保持するスコープ
+   */
+  class DispatchScope : NonCopyable {
+   public:
+    explicit DispatchScope(EventCallbackRegistry& registry)
+        : registry_(registry) {
+      ++registry_.dispatch_depth_;
+    }
+    ~DispatchScope() {
+      if (--registry_.dispatch_depth_ == 0) {
+        registry_.flush();
+      }
+    }
+
+   private:
+    EventCallbackRegistry& registry_;
+  };
+
+  /**
+   * ハンドラーを登録する
+   * @param mask 受け取るイベント種別
+   * @param callback
+   * @return 登録解除に用いるハンドル
+   */
+  EventCallbackHandle add(EventMask mask, CustomEventCallback callback);
+
+  /**
+   * ハンドラーの登録を解除する。既に解除されたハンドルは無視する。
+   * @param handle
+   */
+  void remove(EventCallbackHandle handle);
+
+  /**
+   * 登録解除済みのハンドラーを取り除く。イベントの配送中に呼んではならない。
+   */
+  void compact();
+
+  /**
+   * 登録されているハンドラーを返す。解除済みのハンドラーは removed が真になっている。
+   * 配送中に登録されたハンドラーは配送が終わるまで含まれない。
+   * @return
+   */
+  [[nodiscard]] absl::Span<const EventHandler> handlers() const& {
+    return handlers_;
+  }
+
+ private:
+  /**
+   * 配送中に遅延した登録と解除を反映する
+   */
+  void flush();
+
+  std::vector<EventHandler> handlers_;
+  // 配送中に登録されたハンドラー
+  std::vector<EventHandler> pending_;
+  uint32_t next_id_ = 1;
+  uint32_t dispatch_depth_ = 0;
+  bool has_tombstone_ = false;
+};
+
 class TruffleVisibleObject : public NonCopyable {
  public:
   /**
@@ -32,34 +109,143 @@ class TruffleVisibleObject : public NonCopyable {
    * オブジェクトの幅を設定する
    * @param width
    */
-  void setWidth(int width) { render_rect.w = width; }
+  void setWidth(int width) {
+    render_rect.w = width;
+    invalidateBounds();
+  }
 
   /**
    * オブジェクトの高さを設定する
    * @param height
    */
-  void setHeight(int height) { render_rect.h = height; }
+  void setHeight(int height) {
+    render_rect.h = height;
+    invalidateBounds();
+  }
+
+  /**
+   * 描画順を決めるレイヤーを設定する。大きいレイヤーほど手前に描画される。
+   * @param layer
+   */
+  void setLayer(int32_t layer);
+
+  /**
+   * 同じレイヤー内での描画順を設定する。大きいほど手前に描画される。
+   * @param z
+   */
+  void setZ(int32_t z);
+
+  [[nodiscard]] int32_t layer() const { return layer_; }
+  [[nodiscard]] int32_t z() const { return z_; }
+
+  /**
+   * 描画に用いるテクスチャ。レイヤーとzが等しいオブジェクトは、同じテクスチャを
+   * 用いるもの同士が連続して描画される。テクスチャが変わる場合は invalidateDrawOrder()
+   * を呼ぶこと。
+   * @return テクスチャを用いない場合はnullptr
+   */
+  [[nodiscard]] virtual SDL_Texture const* drawTexture() const {
+    return nullptr;
+  }
 
   /**
    * オブジェクトに属するイベントハンドラーを取得する
    * @return
    */
-  std::forward_list<CustomEventCallback> eventCallbacks() { return callback_; }
+  [[nodiscard]] absl::Span<const EventHandler> eventCallbacks() const& {
+    return callback_.handlers();
+  }
+  EventCallbackRegistry& eventCallbackRegistry() & { return callback_; }
+
+  /**
+   * ポインターを受け付けるか。受け付けるオブジェクトは描画範囲で索引され、
+   * ポインターの直下で最も手前にあるオブジェクトのみが以下のコールバックを受け取る。
+   * @return
+   */
+  [[nodiscard]] bool interactive() const { return interactive_; }
+
+  /**
+   * ポインターが描画範囲に入った時のコールバック。1フレームに1度判定される。
+   */
+  virtual void onPointerEnter() {}
+
+  /**
+   * ポインターが描画範囲から出た時、もしくは手前のオブジェクトに遮られた時のコールバック
+   */
+  virtual void onPointerLeave() {}
+
+  /**
+   * 描画範囲上でマウスボタンが押された時のコールバック
+   * @param event
+   */
+  virtual void onPointerDown(const SDL_MouseButtonEvent& event) {}
+
+  /**
+   * 描画範囲上でマウスボタンが離された時のコールバック
+   * @param event
+   */
+  virtual void onPointerUp(const SDL_MouseButtonEvent& event) {}
+
+  /**
+   * 描画が有効か
+   * @return
+   */
+  [[nodiscard]] bool renderEnabled() const { return do_render_; }
+
+  /**
+   * 参照しているテクスチャが占めるメモリの見積もり。シーンの常駐管理に用いる
+   * @return
+   */
+  [[nodiscard]] virtual size_t residentBytes() const { return 0; }
+
+  /**
+   * 読み込み直せるテクスチャへの参照を捨てる。シーンが長くアクティブでない時に呼ばれる。
+   * 描画範囲は変えないこと。
+   */
+  virtual void releaseResources() {}
+
+  /**
+   * releaseResources() で捨てたテクスチャを読み込み直す。シーンが再びアクティブに
+   * なった時に、描画命令を記録する前に呼ばれる。
+   */
+  virtual void restoreResources() {}
 
   /**
    * メンバに対する描画処理を定義する
+   * @param context レンダラーとフレーム情報。描画中のフレームでのみ有効
+   */
+  virtual void render(RenderContext& context) = 0;
+
+  /**
+   * 固定ステップ間の補間係数を用いて描画する。補間を行わないオブジェクトは
+   * render() をそのまま呼び出す。
+   * @param context 補間係数は RenderContext::alpha
+   */
+  virtual void renderInterpolated(RenderContext& context) { render(context); }
+
+  /**
+   * 描画命令を記録する。既定の実装は描画時に renderInterpolated() を呼ぶ命令を記録する
+   * ため、シミュレーションと描画を並行に行うにはオーバーライドしてテクスチャのコピーとして
+   * 記録すること。
+   * @param commands
    */
-  virtual void render() = 0;
+  virtual void record(RenderCommandList& commands);
 
   /**
    * 描画を有効にする
    */
-  void enableRender() { do_render_ = true; }
+  void enableRender() {
+    do_render_ = true;
+    invalidateContent();
+  }
 
   /**
    * 描画を無効にする
    */
-  void disableRender() { do_render_ = false; }
+  void disableRender() {
+    do_render_ = false;
+    invalidateContent();
+  }
 
   const std::string& name() const& { return name_; }
   const SDL_Rect& renderRect() const& { return render_rect; }
@@ -68,19 +254,67 @@ class TruffleVisibleObject : public NonCopyable {
   TruffleVisibleObject(std::string name);
 
   /**
-   * イベントハンドラーを登録する。
+   * すべてのイベントを受け取るイベントハンドラーを登録する。
    * @param callback
    */
-  void setEventCallback(CustomEventCallback callback) {
-    callback_.push_front(callback);
+  EventCallbackHandle setEventCallback(CustomEventCallback callback) {
+    return setEventCallback(EventMask::all(), std::move(callback));
   }
 
+  /**
+   * マスクに含まれる種別のイベントのみを受け取るイベントハンドラーを登録する。
+   * @param mask 受け取るイベント種別
+   * @param callback
+   * @return 登録解除に用いるハンドル
+   */
+  EventCallbackHandle setEventCallback(EventMask mask,
+                                       CustomEventCallback callback) {
+    return callback_.add(mask, std::move(callback));
+  }
+
+  /**
+   * イベントハンドラーの登録を解除する。
+   * @param handle
+   */
+  void removeEventCallback(EventCallbackHandle handle) {
+    callback_.remove(handle);
+  }
+
+  /**
+   * ポインターを受け付けるかを設定する
+   * @param interactive
+   */
+  void setInteractive(bool interactive);
+
+  /**
+   * レイヤー・z・描画するテクスチャが変わったことを描画リストに通知する
+   */
+  void invalidateDrawOrder();
+
+  /**
+   * 描画範囲内の見た目が変わったことを描画リストに通知する。変化した範囲のみを
+   * 再描画するモードでは、テクスチャの差し替え以外で見た目を変えるオブジェクトは
+   * 変える度に呼ぶこと。
+   */
+  void invalidateContent();
+
   bool do_render_ = true;
 
  private:
+  friend class DrawList;
+
+  // 描画リストが保持している描画範囲を無効にする
+  void invalidateBounds();
+
   std::string name_;
-  SDL_Rect render_rect;
-  std::forward_list<CustomEventCallback> callback_;
+  SDL_Rect render_rect{};
+  EventCallbackRegistry callback_;
+  int32_t layer_ = 0;
+  int32_t z_ = 0;
+  bool interactive_ = false;
+  bool draw_order_dirty_ = false;
+  bool bounds_dirty_ = false;
+  bool content_dirty_ = false;
 };
 
 using TruffleVisibleObjectRef = std::reference_wrapper<TruffleVisibleObject>;
@@ -91,7 +325,10 @@ class TruffleInvisibleObject : NonCopyable {
    * オブジェクトに属するイベントハンドラーを取得する
    * @return
    */
-  std::forward_list<CustomEventCallback> eventCallbacks() { return callback_; }
+  [[nodiscard]] absl::Span<const EventHandler> eventCallbacks() const& {
+    return callback_.handlers();
+  }
+  EventCallbackRegistry& eventCallbackRegistry() & { return callback_; }
 
   const std::string& name() const& { return name_; }
 
@@ -99,16 +336,35 @@ class TruffleInvisibleObject : NonCopyable {
   TruffleInvisibleObject(std::string name);
 
   /**
-   * イベントハンドラーを登録する。
+   * すべてのイベントを受け取るイベントハンドラーを登録する。
    * @param callback
    */
-  void setEventCallback(CustomEventCallback callback) {
-    callback_.push_front(callback);
+  EventCallbackHandle setEventCallback(CustomEventCallback callback) {
+    return setEventCallback(EventMask::all(), std::move(callback));
+  }
+
+  /**
+   * マスクに含まれる種別のイベントのみを受け取るイベントハンドラーを登録する。
+   * @param mask 受け取るイベント種別
+   * @param callback
+   * @return 登録解除に用いるハンドル
+   */
+  EventCallbackHandle setEventCallback(EventMask mask,
+                                       CustomEventCallback callback) {
+    return callback_.add(mask, std::move(callback));
+  }
+
+  /**
+   * イベントハンドラーの登録を解除する。
+   * @param handle
+   */
+  void removeEventCallback(EventCallbackHandle handle) {
+    callback_.remove(handle);
   }
 
  private:
   std::string name_;
-  std::forward_list<CustomEventCallback> callback_;
+  EventCallbackRegistry callback_;
 };
 
 using TruffleInvisibleObjectRef =
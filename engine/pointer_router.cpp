@@ -0,0 +1,214 @@
+/**
+ * @file      pointer_router.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Spatial hash of interactive objects and pointer event routing
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "pointer_router.h"
+
+#include <algorithm>
+
+#include "controller.h"
+
+namespace Truffle {
+
+void HitGrid::build(const DrawList& draw_list) {
+  items_.clear();
+  item_of_.clear();
+  cells_.clear();
+  const auto entries = draw_list.entries();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    auto* object = entries[i].object;
+    if (!object->interactive()) {
+      continue;
+    }
+    const auto item = static_cast<uint32_t>(items_.size());
+    items_.emplace_back(
+        Item{object, static_cast<uint32_t>(i), entries[i].bounds});
+    item_of_.emplace(object, item);
+    insert(item);
+  }
+}
+
+void HitGrid::update(const DrawList& draw_list, bool reordered) {
+  const auto entries = draw_list.entries();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto& entry = entries[i];
+    if (!(reordered || entry.changed) || !entry.object->interactive()) {
+      continue;
+    }
+    const auto it = item_of_.find(entry.object);
+    if (it == item_of_.end()) {
+      continue;
+    }
+    auto& item = items_[it->second];
+    item.rank = static_cast<uint32_t>(i);
+    if (!entry.changed || SDL_RectEquals(&item.bounds, &entry.bounds)) {
+      continue;
+    }
+    erase(it->second);
+    item.bounds = entry.bounds;
+    insert(it->second);
+  }
+}
+
+TruffleVisibleObject* HitGrid::topmost(int x, int y) const {
+  const auto cell = cells_.find(key(cellOf(x), cellOf(y)));
+  if (cell == cells_.end()) {
+    return nullptr;
+  }
+  const SDL_Point point{x, y};
+  const Item* top = nullptr;
+  for (const auto index : cell->second) {
+    const auto& item = items_[index];
+    if (top && item.rank < top->rank) {
+      continue;
+    }
+    if (SDL_PointInRect(&point, &item.bounds) &&
+        item.object->renderEnabled()) {
+      top = &item;
+    }
+  }
+  return top ? top->object : nullptr;
+}
+
+int HitGrid::cellOf(int coordinate) {
+  // 負の座標も切り捨てで求める
+  return coordinate >= 0 ? coordinate / CELL_SIZE
+                         : (coordinate - CELL_SIZE + 1) / CELL_SIZE;
+}
+
+uint64_t HitGrid::key(int cell_x, int cell_y) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) |
+         static_cast<uint32_t>(cell_y);
+}
+
+void HitGrid::insert(uint32_t item) {
+  const auto& bounds = items_[item].bounds;
+  if (bounds.w <= 0 || bounds.h <= 0) {
+    return;
+  }
+  for (int y = cellOf(bounds.y); y <= cellOf(bounds.y + bounds.h - 1); ++y) {
+    for (int x = cellOf(bounds.x); x <= cellOf(bounds.x + bounds.w - 1); ++x) {
+      cells_[key(x, y)].emplace_back(item);
+    }
+  }
+}
+
+void HitGrid::erase(uint32_t item) {
+  const auto& bounds = items_[item].bounds;
+  if (bounds.w <= 0 || bounds.h <= 0) {
+    return;
+  }
+  for (int y = cellOf(bounds.y); y <= cellOf(bounds.y + bounds.h - 1); ++y) {
+    for (int x = cellOf(bounds.x); x <= cellOf(bounds.x + bounds.w - 1); ++x) {
+      const auto cell = cells_.find(key(x, y));
+      if (cell == cells_.end()) {
+        continue;
+      }
+      auto& items = cell->second;
+      items.erase(std::remove(items.begin(), items.end(), item), items.end());
+      if (items.empty()) {
+        cells_.erase(cell);
+      }
+    }
+  }
+}
+
+void PointerRouter::build(const DrawList& draw_list) {
+  grid_.build(draw_list);
+  if (!grid_.contains(hovered_)) {
+    // シーンから外れたオブジェクトは既に破棄されている可能性があるので呼び出さない
+    hovered_ = nullptr;
+  }
+}
+
+void PointerRouter::update(const DrawList& draw_list,
+                           DrawList::Change change) {
+  switch (change) {
+    case DrawList::Change::None:
+      break;
+    case DrawList::Change::Bounds:
+      grid_.update(draw_list, false);
+      break;
+    case DrawList::Change::Order:
+      grid_.update(draw_list, true);
+      break;
+  }
+}
+
+void PointerRouter::leave(const TruffleScene& scene) {
+  if (!hovered_) {
+    return;
+  }
+  // 索引から外れたオブジェクトは破棄されている可能性があるので、参照する前に
+  // シーンに属していることを確かめる
+  for (const auto& [_, controller] : scene.controllers()) {
+    for (const auto& [_, object] : controller.get().visibleObjects()) {
+      if (&object.get() == hovered_) {
+        hover(nullptr);
+        return;
+      }
+    }
+  }
+  hovered_ = nullptr;
+}
+
+void PointerRouter::dispatch(const Event& e) {
+  switch (e.type) {
+    case SDL_WINDOWEVENT:
+      if (e.window.event == SDL_WINDOWEVENT_LEAVE) {
+        has_pointer_ = false;
+        hover(nullptr);
+      }
+      break;
+    case SDL_MOUSEMOTION:
+      has_pointer_ = true;
+      pointer_x_ = e.motion.x;
+      pointer_y_ = e.motion.y;
+      break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+      // 押下の前にホバーを確定させる
+      has_pointer_ = true;
+      pointer_x_ = e.button.x;
+      pointer_y_ = e.button.y;
+      updateHover();
+      if (!hovered_) {
+        break;
+      }
+      if (e.type == SDL_MOUSEBUTTONDOWN) {
+        hovered_->onPointerDown(e.button);
+      } else {
+        hovered_->onPointerUp(e.button);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void PointerRouter::updateHover() {
+  if (!has_pointer_) {
+    return;
+  }
+  hover(grid_.topmost(pointer_x_, pointer_y_));
+}
+
+void PointerRouter::hover(TruffleVisibleObject* object) {
+  if (object == hovered_) {
+    return;
+  }
+  auto* previous = hovered_;
+  hovered_ = object;
+  if (previous) {
+    previous->onPointerLeave();
+  }
+  if (object) {
+    object->onPointerEnter();
+  }
+}
+
+}  // namespace Truffle
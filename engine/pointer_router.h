@@ -0,0 +1,137 @@
+/**
+ * @file      pointer_router.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Spatial hash of interactive objects and pointer event routing
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_POINTER_ROUTER_H
+#define TRUFFLE_POINTER_ROUTER_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "draw_list.h"
+#include "object.h"
+#include "wrapper/sdl2/event.h"
+
+namespace Truffle {
+
+/**
+ * ポインターを受け付けるオブジェクトの描画範囲を一様な格子で索引するクラス。
+ * 点の判定はその点を含むセルに登録されたオブジェクトのみを調べる。
+ */
+class HitGrid {
+ public:
+  // セルの一辺の長さ(ピクセル)
+  static constexpr int CELL_SIZE = 64;
+
+  /**
+   * 描画リストのポインターを受け付けるオブジェクトから索引を再構築する
+   * @param draw_list
+   */
+  void build(const DrawList& draw_list);
+
+  /**
+   * 描画リストで Entry::changed が立っているオブジェクトの描画範囲を更新する。
+   * 順位が変わった場合もセルは作り直さず、各オブジェクトの順位のみを更新する。
+   * @param draw_list
+   * @param reordered エントリの順位が変化したか
+   */
+  void update(const DrawList& draw_list, bool reordered);
+
+  /**
+   * 点を含むオブジェクトのうち、最も手前に描画されるものを返す。
+   * 描画が無効なオブジェクトは除く。
+   * @param x
+   * @param y
+   * @return 存在しなければnullptr
+   */
+  [[nodiscard]] TruffleVisibleObject* topmost(int x, int y) const;
+
+  /**
+   * オブジェクトが索引されているか。オブジェクトは参照しない。
+   * @param object
+   * @return
+   */
+  [[nodiscard]] bool contains(const TruffleVisibleObject* object) const {
+    return item_of_.contains(object);
+  }
+
+ private:
+  struct Item {
+    TruffleVisibleObject* object;
+    // 描画リスト内の順位。大きいほど手前
+    uint32_t rank;
+    SDL_Rect bounds;
+  };
+
+  static int cellOf(int coordinate);
+  static uint64_t key(int cell_x, int cell_y);
+
+  void insert(uint32_t item);
+  void erase(uint32_t item);
+
+  std::vector<Item> items_;
+  absl::flat_hash_map<const TruffleVisibleObject*, uint32_t> item_of_;
+  absl::flat_hash_map<uint64_t, std::vector<uint32_t>> cells_;
+};
+
+/**
+ * ポインターのイベントを直下で最も手前にあるオブジェクトにのみ配送するクラス。
+ * ホバーの開始と終了は1フレームに1度、その時点のポインターの位置で判定する。
+ */
+class PointerRouter {
+ public:
+  /**
+   * 描画リストから索引を再構築する。ホバー中のオブジェクトが索引から外れた場合は
+   * 参照を捨てる。
+   * @param draw_list
+   */
+  void build(const DrawList& draw_list);
+
+  /**
+   * 描画リストの変化を索引に反映する
+   * @param draw_list
+   * @param change DrawList::refresh() の戻り値
+   */
+  void update(const DrawList& draw_list, DrawList::Change change);
+
+  /**
+   * シーンを離れる時に呼ぶ。ホバー中のオブジェクトがまだそのシーンに属していれば
+   * onPointerLeave() を呼ぶ。
+   * @param scene 離れるシーン
+   */
+  void leave(const TruffleScene& scene);
+
+  /**
+   * イベントを処理する。マウスボタンのイベントは直下のオブジェクトに配送し、
+   * 移動イベントはポインターの位置のみを記録する。ポインターがウィンドウの外に
+   * 出た場合はホバーを終える。
+   * @param e
+   */
+  void dispatch(const Event& e);
+
+  /**
+   * 記録したポインターの位置でホバー中のオブジェクトを判定し、変化していれば
+   * onPointerLeave() と onPointerEnter() を呼ぶ。フレーム毎に1度呼ぶこと。
+   */
+  void updateHover();
+
+ private:
+  void hover(TruffleVisibleObject* object);
+
+  HitGrid grid_;
+  TruffleVisibleObject* hovered_ = nullptr;
+  bool has_pointer_ = false;
+  int pointer_x_ = 0;
+  int pointer_y_ = 0;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_POINTER_ROUTER_H
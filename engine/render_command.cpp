@@ -0,0 +1,96 @@
+/**
+ * @file      render_command.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Render commands recorded by objects and submitted by dispatcher
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "render_command.h"
+
+#include "object.h"
+
+namespace Truffle {
+
+void RenderCommandList::clear() {
+  commands_.clear();
+  immediate_count_ = 0;
+  overlay_begin_ = 0;
+  damage_ = DamageRegion{};
+}
+
+void RenderCommandList::copyTexture(SDL_Texture const* texture,
+                                    const SDL_Rect* src, const SDL_Rect& dst) {
+  RenderCommand command{};
+  command.type = RenderCommand::Type::CopyTexture;
+  command.texture = texture;
+  if (src) {
+    command.src = *src;
+    command.has_src = true;
+  }
+  command.dst = dst;
+  commands_.emplace_back(command);
+}
+
+void RenderCommandList::immediate(TruffleVisibleObject& object) {
+  RenderCommand command{};
+  command.type = RenderCommand::Type::Immediate;
+  command.object = &object;
+  commands_.emplace_back(command);
+  ++immediate_count_;
+}
+
+void RenderCommandList::beginLayerCache(size_t slot) {
+  RenderCommand command{};
+  command.type = RenderCommand::Type::BeginLayerCache;
+  command.slot = slot;
+  commands_.emplace_back(command);
+}
+
+void RenderCommandList::endLayerCache() {
+  RenderCommand command{};
+  command.type = RenderCommand::Type::EndLayerCache;
+  commands_.emplace_back(command);
+}
+
+void RenderCommandList::compositeLayer(size_t slot) {
+  RenderCommand command{};
+  command.type = RenderCommand::Type::CompositeLayer;
+  command.slot = slot;
+  commands_.emplace_back(command);
+}
+
+void RenderCommandList::submit(RenderContext& context, size_t begin,
+                               size_t end) const {
+  auto& batcher = context.batcher;
+  for (size_t i = begin; i < end; ++i) {
+    const auto& command = commands_[i];
+    switch (command.type) {
+      case RenderCommand::Type::CopyTexture:
+        batcher.draw(const_cast<SDL_Texture*>(command.texture),
+                     command.has_src ? &command.src : nullptr, command.dst);
+        break;
+      case RenderCommand::Type::Immediate:
+        // オブジェクトはレンダラーに直接描画するので、先に溜まっている矩形を描画する
+        batcher.flush();
+        command.object->renderInterpolated(context);
+        break;
+      case RenderCommand::Type::BeginLayerCache:
+        // キャッシュを作成できなければ、そのまま現在の描画先に描画する
+        batcher.flush();
+        context.layers.begin(context.renderer, command.slot);
+        break;
+      case RenderCommand::Type::EndLayerCache:
+        batcher.flush();
+        context.layers.end(context.renderer);
+        break;
+      case RenderCommand::Type::CompositeLayer:
+        batcher.flush();
+        context.layers.composite(context.renderer, command.slot);
+        break;
+    }
+  }
+  batcher.flush();
+}
+
+}  // namespace Truffle
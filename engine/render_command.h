@@ -0,0 +1,223 @@
+/**
+ * @file      render_command.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Render commands recorded by objects and submitted by dispatcher
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_RENDER_COMMAND_H
+#define TRUFFLE_RENDER_COMMAND_H
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+#include "render_context.h"
+
+namespace Truffle {
+
+class TruffleVisibleObject;
+
+/**
+ * 前のフレームから描画内容が変わった範囲
+ */
+struct DamageRegion {
+  // 全体が変わった、もしくは変わった範囲が不明
+  bool full = true;
+  // full がfalseの時に変わった範囲を包含する矩形。空であれば変化はない
+  SDL_Rect rect{};
+
+  /**
+   * 範囲を追加する。空の矩形は範囲が不明なものとして全体を変化させる。
+   * @param area
+   */
+  void add(const SDL_Rect& area) {
+    if (full) {
+      return;
+    }
+    if (area.w <= 0 || area.h <= 0) {
+      full = true;
+      return;
+    }
+    if (empty()) {
+      rect = area;
+      return;
+    }
+    SDL_UnionRect(&rect, &area, &rect);
+  }
+
+  void addAll() { full = true; }
+
+  void reset() {
+    full = false;
+    rect = SDL_Rect{};
+  }
+
+  [[nodiscard]] bool empty() const {
+    return !full && (rect.w <= 0 || rect.h <= 0);
+  }
+};
+
+/**
+ * 1回分の描画命令
+ */
+struct RenderCommand {
+  enum class Type {
+    // テクスチャを描画先の矩形にコピーする
+    CopyTexture,
+    // 描画時にオブジェクトの renderInterpolated() を直接呼び出す
+    Immediate,
+    // 以降の描画先を静的な層のキャッシュに切り替える
+    BeginLayerCache,
+    // 描画先を元に戻す
+    EndLayerCache,
+    // 静的な層のキャッシュを合成する
+    CompositeLayer,
+  };
+
+  Type type;
+  SDL_Texture const* texture;
+  SDL_Rect src;
+  bool has_src;
+  SDL_Rect dst;
+  TruffleVisibleObject* object;
+  // LayerCache のスロット
+  size_t slot;
+};
+
+/**
+ * オブジェクトが記録した1フレーム分の描画命令のリスト。記録が終わった後は不変であり、
+ * シミュレーションスレッドで記録したリストをメインスレッドで描画することができる。
+ */
+class RenderCommandList {
+ public:
+  /**
+   * 記録済みの描画命令を破棄する。確保済みの領域は再利用される。
+   */
+  void clear();
+
+  /**
+   * テクスチャのコピーを記録する
+   * @param texture 描画するテクスチャ
+   * @param src テクスチャ内の矩形。nullptrであればテクスチャ全体
+   * @param dst 描画先の矩形
+   */
+  void copyTexture(SDL_Texture const* texture, const SDL_Rect* src,
+                   const SDL_Rect& dst);
+
+  /**
+   * 描画時にオブジェクトを直接描画することを記録する。この命令を含むリストは
+   * オブジェクトの状態を参照するので、シミュレーションと並行に描画できない。
+   * @param object
+   */
+  void immediate(TruffleVisibleObject& object);
+
+  /**
+   * 以降に記録する描画命令を静的な層のキャッシュに描画することを記録する。
+   * endLayerCache() までの命令はキャッシュを作り直す時にのみ記録すること。
+   * @param slot キャッシュのスロット
+   */
+  void beginLayerCache(size_t slot);
+
+  /**
+   * 描画先を beginLayerCache() の前に戻すことを記録する
+   */
+  void endLayerCache();
+
+  /**
+   * 静的な層のキャッシュを描画先全体に合成することを記録する
+   * @param slot キャッシュのスロット
+   */
+  void compositeLayer(size_t slot);
+
+  /**
+   * 以降に記録する描画命令をシーンの上に重ねるオーバーレイとする。オーバーレイは
+   * 変化した範囲の再描画の対象にならず、毎フレーム描画される。
+   */
+  void beginOverlay() { overlay_begin_ = commands_.size(); }
+
+  /**
+   * 記録した描画命令をすべて実行する。同じテクスチャを連続して描画する命令は
+   * まとめて描画される。メインスレッドから呼ぶこと。
+   * @param context バッチャーを begin() 済みのコンテキスト
+   */
+  void submit(RenderContext& context) const {
+    submit(context, 0, commands_.size());
+  }
+
+  /**
+   * オーバーレイを除くシーンの描画命令を実行する
+   * @param context バッチャーを begin() 済みのコンテキスト
+   */
+  void submitScene(RenderContext& context) const {
+    submit(context, 0, overlay_begin_);
+  }
+
+  /**
+   * オーバーレイの描画命令を実行する
+   * @param context バッチャーを begin() 済みのコンテキスト
+   */
+  void submitOverlay(RenderContext& context) const {
+    submit(context, overlay_begin_, commands_.size());
+  }
+
+  /**
+   * シミュレーションと並行に描画できない命令を含むか
+   * @return
+   */
+  [[nodiscard]] bool requiresSync() const { return immediate_count_ > 0; }
+
+  /**
+   * 前のフレームから描画内容が変わった範囲
+   */
+  void setDamage(const DamageRegion& damage) { damage_ = damage; }
+  [[nodiscard]] const DamageRegion& damage() const& { return damage_; }
+
+  /**
+   * 描画時の補間係数
+   */
+  void setAlpha(double alpha) { alpha_ = alpha; }
+  [[nodiscard]] double alpha() const { return alpha_; }
+
+  /**
+   * 記録したフレームの番号と前フレームからの経過時間(秒)
+   */
+  void setFrame(uint64_t frame, double delta_time) {
+    frame_ = frame;
+    delta_time_ = delta_time;
+  }
+  [[nodiscard]] uint64_t frame() const { return frame_; }
+  [[nodiscard]] double deltaTime() const { return delta_time_; }
+
+  /**
+   * 描画命令を記録したフレームのフェーズの所要時間。表示したフレームの計測に加算される。
+   * clear() ではリセットされない。
+   */
+  [[nodiscard]] FramePhaseTimes& phaseTimes() { return phase_times_; }
+  [[nodiscard]] const FramePhaseTimes& phaseTimes() const {
+    return phase_times_;
+  }
+
+  [[nodiscard]] const std::vector<RenderCommand>& commands() const& {
+    return commands_;
+  }
+
+ private:
+  void submit(RenderContext& context, size_t begin, size_t end) const;
+
+  std::vector<RenderCommand> commands_;
+  size_t immediate_count_ = 0;
+  size_t overlay_begin_ = 0;
+  DamageRegion damage_;
+  double alpha_ = 0;
+  uint64_t frame_ = 0;
+  double delta_time_ = 0;
+  FramePhaseTimes phase_times_{};
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_RENDER_COMMAND_H
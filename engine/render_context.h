@@ -0,0 +1,43 @@
+/**
+ * @file      render_context.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Per-frame state passed to render implementations
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_RENDER_CONTEXT_H
+#define TRUFFLE_RENDER_CONTEXT_H
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+
+#include "wrapper/sdl2/layer_cache.h"
+#include "wrapper/sdl2/sprite_batcher.h"
+
+namespace Truffle {
+
+/**
+ * 1フレームの描画に必要な状態。Dispatcherがフレーム毎に1度だけ構築し、描画命令の実行と
+ * TruffleVisibleObject::render() に渡す。描画中にシングルトンからレンダラーを
+ * 引かずに済むように、生のポインタを保持する。メインスレッドでのみ有効。
+ */
+struct RenderContext {
+  // 描画先のレンダラー
+  SDL_Renderer* renderer;
+  // begin() 済みのバッチャー。直接レンダラーに描画する前に flush() すること
+  SpriteBatcher& batcher;
+  // 静的な層のキャッシュ
+  LayerCache& layers;
+  // 直前の固定ステップから次の固定ステップまでの経過割合 [0, 1)
+  double alpha;
+  // 描画するフレームの番号
+  uint64_t frame;
+  // 描画するフレームの前フレームからの経過時間(秒)
+  double delta_time;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_RENDER_CONTEXT_H
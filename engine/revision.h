@@ -0,0 +1,69 @@
+/**
+ * @file      revision.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Revision counter of registered scenes, controllers and objects
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_REVISION_H
+#define TRUFFLE_REVISION_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/singleton.h"
+
+namespace Truffle {
+
+/**
+ * コントローラー・オブジェクト・イベントハンドラーの登録状況が変化する度に加算される
+ * カウンタ。ディスパッチャーはこれを監視して、キャッシュしている索引を再構築する。
+ */
+class SceneGraphRevision : public MutableSingleton<SceneGraphRevision> {
+ public:
+  static void bump() { SceneGraphRevision::get().bump_(); }
+
+  static uint64_t current() { return SceneGraphRevision::get().current_(); }
+
+ private:
+  friend class MutableSingleton<SceneGraphRevision>;
+
+  SceneGraphRevision() = default;
+
+  void bump_() { revision_.fetch_add(1, std::memory_order_relaxed); }
+
+  uint64_t current_() const {
+    return revision_.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> revision_{0};
+};
+
+/**
+ * オブジェクトのレイヤー・z・描画するテクスチャ・描画範囲が変化する度に加算される
+ * カウンタ。ディスパッチャーはこれを監視して、描画リストを更新する。
+ */
+class DrawOrderRevision : public MutableSingleton<DrawOrderRevision> {
+ public:
+  static void bump() { DrawOrderRevision::get().bump_(); }
+
+  static uint64_t current() { return DrawOrderRevision::get().current_(); }
+
+ private:
+  friend class MutableSingleton<DrawOrderRevision>;
+
+  DrawOrderRevision() = default;
+
+  void bump_() { revision_.fetch_add(1, std::memory_order_relaxed); }
+
+  uint64_t current_() const {
+    return revision_.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> revision_{0};
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_REVISION_H
@@ -17,7 +17,7 @@ namespace Truffle {
 class Router : public ConstSingleton<Router> {
  public:
   template <class T>
-  bool transport(Address address, T&& message) {
+  static bool transport(Address address, T&& message) {
     return Router::get().transport_(address, std::forward<T&&>(message));
   }
 
@@ -27,11 +27,11 @@ class Router : public ConstSingleton<Router> {
   Router() = default;
 
   template <class T>
-  bool transport_(Address address, T&& message);
+  bool transport_(Address address, T&& message) const;
 };
 
 template <class T>
-bool Router::transport_(Address address, T&& message) {
+bool Router::transport_(Address address, T&& message) const {
   auto actor = ActorTable::get().lookup(address);
   if (!actor.has_value()) {
     return false;
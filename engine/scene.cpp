@@ -12,6 +12,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "revision.h"
 
 namespace Truffle {
 
@@ -32,6 +33,12 @@ void TruffleScene::setController(TruffleController& controller) {
               absl::StrFormat("controller %s registered to scene %s",
                               controller.name(), name_));
   controllers_.emplace(controller.name(), controller);
+  SceneGraphRevision::bump();
+}
+
+void TruffleScene::declareStaticLayer(int32_t layer) {
+  static_layers_.emplace(layer);
+  SceneGraphRevision::bump();
 }
 
 }  // namespace Truffle
\ No newline at end of file
@@ -10,14 +10,25 @@
 #define TRUFFLE_SCENE_H
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/non_copyable.h"
 #include "controller.h"
+#include "wrapper/sdl2/texture.h"
 
 namespace Truffle {
 
+// シーンが用いる画像
+struct SceneImageAsset {
+  std::string path;
+  TextureLoadOptions options;
+};
+
 class TruffleScene : NonCopyable {
  public:
   explicit TruffleScene(std::string scene_name);
@@ -42,10 +53,56 @@ class TruffleScene : NonCopyable {
     return controllers_;
   }
 
+  /**
+   * レイヤーに属する可視オブジェクトがほとんど変化しないことを宣言する。
+   * そのレイヤーのオブジェクトはまとめてテクスチャに描画され、毎フレーム1回のコピーで
+   * 合成される。いずれかのオブジェクトが変化するとテクスチャは描画し直される。
+   * @param layer
+   */
+  void declareStaticLayer(int32_t layer);
+
+  /**
+   * 静止していると宣言されたレイヤー
+   * @return
+   */
+  [[nodiscard]] const absl::flat_hash_set<int32_t>& staticLayers() const& {
+    return static_layers_;
+  }
+
+  /**
+   * シーンが用いる画像を宣言する。このシーンへ遷移できるシーンがアクティブな間に
+   * バックグラウンドで読み込まれ、遷移時のTextureの生成はキャッシュから行われる。
+   * シーンの構築時に宣言すること。
+   * @param path
+   * @param options
+   */
+  void preloadImage(std::string path, const TextureLoadOptions& options = {}) {
+    preload_images_.emplace_back(SceneImageAsset{std::move(path), options});
+  }
+
+  /**
+   * シーンが用いるフォントを宣言する。画像と同様に遷移前に開かれる。
+   * @param name FontStorage::loadFont() で登録した名前
+   * @param size
+   */
+  void preloadFont(std::string name, size_t size) {
+    preload_fonts_.emplace_back(FontInfo{size, std::move(name)});
+  }
+
+  [[nodiscard]] const std::vector<SceneImageAsset>& preloadImages() const& {
+    return preload_images_;
+  }
+  [[nodiscard]] const std::vector<FontInfo>& preloadFonts() const& {
+    return preload_fonts_;
+  }
+
   [[nodiscard]] const std::string& name() const& { return name_; }
 
  private:
   std::string name_;
+  absl::flat_hash_set<int32_t> static_layers_;
+  std::vector<SceneImageAsset> preload_images_;
+  std::vector<FontInfo> preload_fonts_;
   absl::flat_hash_map<std::string, TruffleControllerRef> controllers_;
 };
 
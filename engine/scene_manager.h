@@ -15,12 +15,14 @@
 #include <mutex>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/non_copyable.h"
 #include "common/singleton.h"
 #include "common/stateful_object_manager.h"
+#include "common/trace.h"
 #include "scene.h"
 #include "wrapper/sdl2/event.h"
 
@@ -71,6 +73,18 @@ class SceneManager : public MutableSingleton<SceneManager<SceneState>>,
    */
   SceneState currentSceneState() { return state_manager_.activeState(); }
 
+  /**
+   * 現在のシーンから遷移できるシーンを返す
+   * @return
+   */
+  std::vector<const TruffleScene*> nextScenes();
+
+  /**
+   * 登録されているすべてのシーンを返す
+   * @return
+   */
+  std::vector<const TruffleScene*> scenes() const;
+
  private:
   std::queue<SceneState> pending_scene_transition_;
   StatefulObjectManager<TruffleScene, SceneState> state_manager_;
@@ -101,6 +115,25 @@ void SceneManager<SceneState>::setSceneTransition(SceneState from,
   state_manager_.setStateTransition(to, from);
 }
 
+template <class SceneState>
+std::vector<const TruffleScene*> SceneManager<SceneState>::nextScenes() {
+  std::vector<const TruffleScene*> scenes;
+  for (const auto state :
+       state_manager_.reachableStates(state_manager_.activeState())) {
+    scenes.emplace_back(&state_manager_.statefulObject(state));
+  }
+  return scenes;
+}
+
+template <class SceneState>
+std::vector<const TruffleScene*> SceneManager<SceneState>::scenes() const {
+  std::vector<const TruffleScene*> scenes;
+  for (const auto& [_, scene] : state_manager_.allManagedStatefulObject()) {
+    scenes.emplace_back(scene.get());
+  }
+  return scenes;
+}
+
 template <class SceneState>
 void SceneManager<SceneState>::sendSceneTransitionSignal(SceneState dst_scene) {
   // SDL_PushEventはスレッドセーフだがstd::queueはスレッドセーフではないので、
@@ -118,6 +151,7 @@ void SceneManager<SceneState>::sendSceneTransitionSignal(SceneState dst_scene) {
 
 template <class SceneState>
 void SceneManager<SceneState>::transitScene() {
+  TRUFFLE_TRACE_ZONE("SceneManager::transitScene");
   if (pending_scene_transition_.empty()) {
     Logger::log(LogLevel::WARN,
                 "Can't invoke scene transition with empty pending queue");
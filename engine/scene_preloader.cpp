@@ -0,0 +1,120 @@
+/**
+ * @file      scene_preloader.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Background preloading of assets for reachable scenes
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "scene_preloader.h"
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_format.h>
+
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/trace.h"
+#include "wrapper/sdl2/font_storage.h"
+
+namespace Truffle {
+
+void ScenePreloader::retarget(const TruffleScene& current,
+                              absl::Span<const TruffleScene* const> next) {
+  target_ = &current;
+  queued_images_.clear();
+  queued_fonts_.clear();
+  if (budget_ == 0) {
+    images_.clear();
+    return;
+  }
+
+  // 遷移先の画像を優先し、現在のシーンの画像は最後に読み込む
+  absl::flat_hash_set<Key> wanted;
+  std::vector<std::pair<Key, SceneImageAsset>> ordered;
+  const auto collect = [&](const TruffleScene& scene) {
+    for (const auto& asset : scene.preloadImages()) {
+      Key key{TextureCache::canonicalPath(asset.path),
+              asset.options.blend_mode};
+      if (wanted.insert(key).second) {
+        ordered.emplace_back(std::move(key), asset);
+      }
+    }
+  };
+  for (const auto* scene : next) {
+    collect(*scene);
+    queued_fonts_.insert(queued_fonts_.end(), scene->preloadFonts().begin(),
+                         scene->preloadFonts().end());
+  }
+  collect(current);
+
+  absl::erase_if(images_, [&wanted](const auto& image) {
+    return !wanted.contains(image.first);
+  });
+  for (auto& image : ordered) {
+    if (!images_.contains(image.first)) {
+      queued_images_.emplace_back(std::move(image));
+    }
+  }
+}
+
+void ScenePreloader::update() {
+  if (queued_images_.empty() && queued_fonts_.empty()) {
+    return;
+  }
+  TRUFFLE_TRACE_ZONE("ScenePreloader::update");
+
+  if (!queued_images_.empty()) {
+    size_t in_flight = 0;
+    for (const auto& [_, image] : images_) {
+      if (image.pending()) {
+        ++in_flight;
+      }
+    }
+    auto loaded = bytes();
+    while (!queued_images_.empty() && in_flight < MAX_IN_FLIGHT &&
+           loaded < budget_) {
+      auto [key, asset] = std::move(queued_images_.front());
+      queued_images_.pop_front();
+      auto image = TextureLoader::load(asset.path, asset.options);
+      if (image.ready()) {
+        loaded += image.texture()->bytes();
+      } else {
+        ++in_flight;
+      }
+      images_.emplace(std::move(key), std::move(image));
+    }
+    if (loaded >= budget_ && !queued_images_.empty()) {
+      Logger::log(LogLevel::INFO,
+                  absl::StrFormat("scene preload budget exhausted, %d images "
+                                  "are loaded on demand",
+                                  queued_images_.size()));
+      queued_images_.clear();
+    }
+  }
+
+  // FontStorage はスレッドセーフではないので、メインスレッドで1フレームに1つずつ開く
+  if (!queued_fonts_.empty()) {
+    const auto font = std::move(queued_fonts_.front());
+    queued_fonts_.pop_front();
+    try {
+      FontStorage::openFont(font.name, font.size);
+    } catch (const TruffleException& e) {
+      Logger::log(LogLevel::WARN,
+                  absl::StrFormat("Failed to preload font: %s", e.what()));
+    }
+  }
+}
+
+size_t ScenePreloader::bytes() const {
+  size_t bytes = 0;
+  for (const auto& [_, image] : images_) {
+    if (image.ready()) {
+      bytes += image.texture()->bytes();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace Truffle
@@ -0,0 +1,84 @@
+/**
+ * @file      scene_preloader.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Background preloading of assets for reachable scenes
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_SCENE_PRELOADER_H
+#define TRUFFLE_SCENE_PRELOADER_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "scene.h"
+#include "wrapper/sdl2/texture.h"
+#include "wrapper/sdl2/texture_loader.h"
+
+namespace Truffle {
+
+/**
+ * 現在のシーンから遷移できるシーンが宣言した画像とフォントを先読みするクラス。
+ * 画像は TextureLoader で読み込み、対象である間は参照を保持してキャッシュからの
+ * 追い出しを防ぐ。保持する画像の合計が予算に達すると新たな読み込みは行わない。
+ * 画像の大きさは読み込むまで分からないので、最大で MAX_IN_FLIGHT 枚分予算を超える。
+ */
+class ScenePreloader {
+ public:
+  // 同時に読み込む画像の最大数
+  static constexpr size_t MAX_IN_FLIGHT = TextureLoader::WORKER_THREADS * 2;
+
+  /**
+   * @param budget 先読みした画像を保持するメモリ予算(バイト)。0であれば先読みしない
+   */
+  explicit ScenePreloader(size_t budget) : budget_(budget) {}
+
+  /**
+   * 先読みの対象を、現在のシーンと遷移先のシーンが宣言した素材に置き換える。
+   * 現在のシーンの画像も保持するので、遷移して戻る場合も読み込み直さない。
+   * 対象から外れた画像の参照は捨てる。
+   * @param current
+   * @param next
+   */
+  void retarget(const TruffleScene& current,
+                absl::Span<const TruffleScene* const> next);
+
+  /**
+   * 予算内で画像の読み込みを開始し、フォントを1つ開く。フレーム毎にメインスレッドから
+   * 呼ぶこと。
+   */
+  void update();
+
+  /**
+   * retarget() に与えた現在のシーン
+   * @return
+   */
+  [[nodiscard]] const TruffleScene* target() const { return target_; }
+
+  /**
+   * 読み込みを終えて保持している画像のバイト数
+   * @return
+   */
+  [[nodiscard]] size_t bytes() const;
+
+ private:
+  using Key = std::pair<std::string, SDL_BlendMode>;
+
+  size_t budget_;
+  const TruffleScene* target_ = nullptr;
+  // 読み込みを開始していない画像
+  std::deque<std::pair<Key, SceneImageAsset>> queued_images_;
+  std::deque<FontInfo> queued_fonts_;
+  absl::flat_hash_map<Key, AsyncTexture> images_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_SCENE_PRELOADER_H
@@ -0,0 +1,166 @@
+/**
+ * @file      scene_residency.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Release and restore textures of scenes not visited recently
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "scene_residency.h"
+
+#include <absl/strings/str_format.h>
+
+#include <algorithm>
+
+#include "common/logger.h"
+#include "common/trace.h"
+#include "wrapper/sdl2/texture_cache.h"
+
+namespace Truffle {
+
+void SceneResidency::visit(const TruffleScene& scene,
+                           absl::Span<const TruffleScene* const> scenes) {
+  TRUFFLE_TRACE_ZONE("SceneResidency::visit");
+  auto& record = records_[&scene];
+  record.last_visit = ++visits_;
+  if (!record.resident) {
+    restore(scene);
+    record.resident = true;
+  }
+  if (budget_ == 0) {
+    return;
+  }
+  const TruffleScene* const keep[] = {&scene};
+  evict(keep, scenes);
+}
+
+void SceneResidency::warm(const TruffleScene& current,
+                          absl::Span<const TruffleScene* const> next,
+                          absl::Span<const TruffleScene* const> scenes) {
+  if (budget_ == 0) {
+    return;
+  }
+  TRUFFLE_TRACE_ZONE("SceneResidency::warm");
+  size_t kept = estimatedBytes(current);
+  for (const auto* scene : next) {
+    if (scene != &current && records_[scene].resident) {
+      kept += estimatedBytes(*scene);
+    }
+  }
+  for (const auto* scene : next) {
+    auto& record = records_[scene];
+    // 収まらないシーンはアクティブになった時に読み込み直す
+    if (record.resident || kept + record.bytes > budget_) {
+      continue;
+    }
+    restore(*scene);
+    record.resident = true;
+    kept += record.bytes;
+    Logger::log(LogLevel::DEBUG,
+                absl::StrFormat("scene %s restored ahead of activation",
+                                scene->name()));
+  }
+
+  std::vector<const TruffleScene*> keep(next.begin(), next.end());
+  keep.emplace_back(&current);
+  evict(keep, scenes);
+}
+
+void SceneResidency::evict(absl::Span<const TruffleScene* const> keep,
+                           absl::Span<const TruffleScene* const> scenes) {
+  struct Candidate {
+    const TruffleScene* scene;
+    size_t bytes;
+    uint64_t last_visit;
+  };
+  std::vector<Candidate> candidates;
+  size_t total = 0;
+  for (const auto* other : scenes) {
+    const auto& other_record = records_[other];
+    if (!other_record.resident) {
+      continue;
+    }
+    const auto bytes = estimatedBytes(*other);
+    total += bytes;
+    if (std::find(keep.begin(), keep.end(), other) == keep.end()) {
+      candidates.emplace_back(Candidate{other, bytes, other_record.last_visit});
+    }
+  }
+  if (total <= budget_) {
+    return;
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.last_visit < b.last_visit;
+            });
+  for (const auto& candidate : candidates) {
+    if (total <= budget_) {
+      break;
+    }
+    const auto evicted = release(*candidate.scene);
+    auto& candidate_record = records_[candidate.scene];
+    candidate_record.resident = false;
+    candidate_record.evicted_bytes += evicted;
+    candidate_record.bytes = candidate.bytes;
+    total -= candidate.bytes;
+    Logger::log(LogLevel::DEBUG,
+                absl::StrFormat("scene %s released %d bytes, evicted %d bytes",
+                                candidate.scene->name(), candidate.bytes,
+                                evicted));
+  }
+}
+
+size_t SceneResidency::estimatedBytes(const TruffleScene& scene) {
+  return std::max(residentBytes(scene), records_[&scene].bytes);
+}
+
+std::vector<SceneResidencyStats> SceneResidency::stats(
+    absl::Span<const TruffleScene* const> scenes) const {
+  std::vector<SceneResidencyStats> stats;
+  stats.reserve(scenes.size());
+  for (const auto* scene : scenes) {
+    SceneResidencyStats scene_stats;
+    scene_stats.name = scene->name();
+    scene_stats.bytes = residentBytes(*scene);
+    if (const auto it = records_.find(scene); it != records_.end()) {
+      scene_stats.resident = it->second.resident;
+      scene_stats.last_visit = it->second.last_visit;
+      scene_stats.evicted_bytes = it->second.evicted_bytes;
+    }
+    stats.emplace_back(std::move(scene_stats));
+  }
+  return stats;
+}
+
+size_t SceneResidency::residentBytes(const TruffleScene& scene) {
+  size_t bytes = 0;
+  for (const auto& [_, controller] : scene.controllers()) {
+    for (const auto& [_, object] : controller.get().visibleObjects()) {
+      bytes += object.get().residentBytes();
+    }
+  }
+  return bytes;
+}
+
+size_t SceneResidency::release(const TruffleScene& scene) {
+  // キャッシュの予算は常駐の予算より大きいことが多いので、trim() では捨てさせた
+  // テクスチャが残り続ける。参照を捨てる前後で参照されなくなったものを追い出す
+  const auto referenced = TextureCache::referenced();
+  for (const auto& [_, controller] : scene.controllers()) {
+    for (auto& [_, object] : controller.get().visibleObjects()) {
+      object.get().releaseResources();
+    }
+  }
+  return TextureCache::evictUnreferenced(referenced);
+}
+
+void SceneResidency::restore(const TruffleScene& scene) {
+  for (const auto& [_, controller] : scene.controllers()) {
+    for (auto& [_, object] : controller.get().visibleObjects()) {
+      object.get().restoreResources();
+    }
+  }
+}
+
+}  // namespace Truffle
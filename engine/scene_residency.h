@@ -0,0 +1,130 @@
+/**
+ * @file      scene_residency.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Release and restore textures of scenes not visited recently
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_SCENE_RESIDENCY_H
+#define TRUFFLE_SCENE_RESIDENCY_H
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "scene.h"
+
+namespace Truffle {
+
+struct SceneResidencyStats {
+  std::string name;
+  // シーンのオブジェクトが参照しているテクスチャのバイト数。他のシーンと共有している
+  // テクスチャも含む
+  size_t bytes = 0;
+  // テクスチャを保持しているか
+  bool resident = true;
+  // 最後にアクティブになった順番。大きいほど最近。0であれば一度もアクティブになっていない
+  uint64_t last_visit = 0;
+  // 解放した際に TextureCache から追い出したテクスチャのバイト数の累計
+  size_t evicted_bytes = 0;
+};
+
+/**
+ * シーンのテクスチャの常駐を管理するクラス。常駐しているシーンのテクスチャの合計が
+ * 予算を超えると、最も長くアクティブになっていないシーンのオブジェクトから
+ * TruffleVisibleObject::releaseResources() で参照を捨てさせ、どこからも参照されなく
+ * なったテクスチャを TextureCache の予算に関わらず破棄する。シーンが再びアクティブになった時は
+ * TruffleVisibleObject::restoreResources() で読み込み直す。遷移しうるシーンは warm() で
+ * アクティブになる前に読み込み直しておき、遷移直後に画像が欠けないようにする。
+ */
+class SceneResidency {
+ public:
+  /**
+   * @param budget 常駐させるシーンのテクスチャのメモリ予算(バイト)。0であれば解放しない
+   */
+  explicit SceneResidency(size_t budget) : budget_(budget) {}
+
+  /**
+   * シーンがアクティブになったことを記録する。解放済みであれば読み込み直し、
+   * 予算を超えていれば他のシーンを解放する。シーンのオブジェクトを操作するので、
+   * 描画命令を記録する前にシミュレーションを行うスレッドから呼ぶこと。
+   * @param scene アクティブになったシーン
+   * @param scenes 登録されているすべてのシーン
+   */
+  void visit(const TruffleScene& scene,
+             absl::Span<const TruffleScene* const> scenes);
+
+  /**
+   * 遷移しうるシーンのうち解放済みのものを、予算に収まる限り読み込み直す。
+   * 読み込みは非同期に行われる。予算を超えていれば遷移しうるシーン以外を解放する。
+   * visit() と同じくシーンのオブジェクトを操作するので、シミュレーションを行っていない間に
+   * 呼ぶこと。
+   * @param current アクティブなシーン
+   * @param next アクティブなシーンから遷移しうるシーン
+   * @param scenes 登録されているすべてのシーン
+   */
+  void warm(const TruffleScene& current,
+            absl::Span<const TruffleScene* const> next,
+            absl::Span<const TruffleScene* const> scenes);
+
+  /**
+   * シーン毎の常駐状況
+   * @param scenes 登録されているすべてのシーン
+   * @return
+   */
+  [[nodiscard]] std::vector<SceneResidencyStats> stats(
+      absl::Span<const TruffleScene* const> scenes) const;
+
+  /**
+   * シーンのオブジェクトが参照しているテクスチャのバイト数
+   * @param scene
+   * @return
+   */
+  static size_t residentBytes(const TruffleScene& scene);
+
+ private:
+  struct Record {
+    bool resident = true;
+    uint64_t last_visit = 0;
+    size_t evicted_bytes = 0;
+    // 最後に解放した時点で参照していたテクスチャのバイト数。読み込み直している間の見積もりに使う
+    size_t bytes = 0;
+  };
+
+  /**
+   * 常駐しているシーンのテクスチャの合計が予算に収まるまで、keep 以外のシーンを
+   * 最も長くアクティブになっていないものから解放する
+   * @param keep 解放しないシーン
+   * @param scenes 登録されているすべてのシーン
+   */
+  void evict(absl::Span<const TruffleScene* const> keep,
+             absl::Span<const TruffleScene* const> scenes);
+
+  /**
+   * 常駐しているシーンのバイト数。読み込み直している間は解放した時点のバイト数で見積もる
+   * @param scene
+   * @return
+   */
+  size_t estimatedBytes(const TruffleScene& scene);
+
+  /**
+   * シーンのオブジェクトに参照を捨てさせ、参照されなくなったテクスチャを追い出す
+   * @param scene
+   * @return 追い出したテクスチャのバイト数
+   */
+  static size_t release(const TruffleScene& scene);
+  static void restore(const TruffleScene& scene);
+
+  size_t budget_;
+  uint64_t visits_ = 0;
+  absl::flat_hash_map<const TruffleScene*, Record> records_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_SCENE_RESIDENCY_H
@@ -0,0 +1,48 @@
+/**
+ * @file      timestep.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Fixed timestep accumulator for simulation loop
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "timestep.h"
+
+#include "common/exception.h"
+
+namespace Truffle {
+
+FixedTimestep::FixedTimestep(uint32_t tick_rate, uint32_t max_catchup_ticks)
+    : max_catchup_ticks_(max_catchup_ticks) {
+  if (tick_rate == 0) {
+    throw TruffleException("tick rate must be greater than 0");
+  }
+  if (max_catchup_ticks == 0) {
+    throw TruffleException("max catchup ticks must be greater than 0");
+  }
+  tick_ = std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::duration<double>(1.0 / tick_rate));
+}
+
+uint32_t FixedTimestep::advance(SteadyClock::duration elapsed) {
+  accumulator_ += elapsed;
+  auto ticks = static_cast<uint64_t>(accumulator_ / tick_);
+  if (ticks > max_catchup_ticks_) {
+    // 追いつけない分は破棄し、端数のみを次フレームへ持ち越す
+    accumulator_ %= tick_;
+    return max_catchup_ticks_;
+  }
+  accumulator_ -= tick_ * ticks;
+  return static_cast<uint32_t>(ticks);
+}
+
+double FixedTimestep::alpha() const {
+  return std::chrono::duration<double>(accumulator_) /
+         std::chrono::duration<double>(tick_);
+}
+
+double FixedTimestep::tickSeconds() const {
+  return std::chrono::duration<double>(tick_).count();
+}
+
+}  // namespace Truffle
@@ -0,0 +1,61 @@
+/**
+ * @file      timestep.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Fixed timestep accumulator for simulation loop
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_TIMESTEP_H
+#define TRUFFLE_TIMESTEP_H
+
+#include <chrono>
+#include <cstdint>
+
+#include "metrics.h"
+
+namespace Truffle {
+
+/**
+ * 描画フレームとは独立した固定間隔のシミュレーションステップを管理するクラス。
+ * 経過時間をアキュムレータに蓄積し、フレーム毎に実行すべきステップ数を返す。
+ */
+class FixedTimestep {
+ public:
+  /**
+   * @param tick_rate 1秒あたりの固定ステップ数
+   * @param max_catchup_ticks 1フレームで実行できる固定ステップの最大数。1以上
+   */
+  FixedTimestep(uint32_t tick_rate, uint32_t max_catchup_ticks);
+
+  /**
+   * 経過時間を蓄積し、このフレームで実行すべき固定ステップ数を返す。
+   * 最大数を超えた分の時間は破棄し、ヒッチ後にシミュレーションが追いつこうとして
+   * 処理落ちが連鎖することを防ぐ。
+   * @param elapsed 前フレームからの経過時間
+   * @return
+   */
+  uint32_t advance(SteadyClock::duration elapsed);
+
+  /**
+   * 直前の固定ステップから次の固定ステップまでの経過割合 [0, 1) を返す。
+   * 描画時の補間に用いる。
+   * @return
+   */
+  [[nodiscard]] double alpha() const;
+
+  /**
+   * 1固定ステップの長さを秒で返す
+   * @return
+   */
+  [[nodiscard]] double tickSeconds() const;
+
+ private:
+  SteadyClock::duration tick_;
+  SteadyClock::duration accumulator_{0};
+  uint32_t max_catchup_ticks_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_TIMESTEP_H
@@ -0,0 +1,65 @@
+/**
+ * @file      update_scheduler.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Schedule controller updates onto worker threads
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "update_scheduler.h"
+
+#include <algorithm>
+
+namespace Truffle {
+
+UpdateScheduler::UpdateScheduler(size_t worker_count) : pool_(worker_count) {}
+
+void UpdateScheduler::build(const TruffleScene& scene) {
+  waves_.clear();
+  serial_.clear();
+
+  for (const auto& [_, controller_ref] : scene.controllers()) {
+    auto& controller = controller_ref.get();
+    const bool declared = !controller.readSet().empty() ||
+                          !controller.writeSet().empty();
+    if (!controller.threadSafe() && !declared) {
+      serial_.emplace_back(&controller);
+      continue;
+    }
+    // 競合しない最初のウェーブに詰める
+    auto wave = std::find_if(
+        waves_.begin(), waves_.end(),
+        [&controller](const std::vector<TruffleController*>& members) {
+          return std::none_of(members.begin(), members.end(),
+                              [&controller](const TruffleController* member) {
+                                return conflicts(controller, *member);
+                              });
+        });
+    if (wave == waves_.end()) {
+      waves_.emplace_back(std::vector<TruffleController*>{&controller});
+    } else {
+      wave->emplace_back(&controller);
+    }
+  }
+}
+
+bool UpdateScheduler::conflicts(const TruffleController& a,
+                                const TruffleController& b) {
+  auto contains = [](const std::vector<std::string>& set,
+                     const std::string& resource) {
+    return std::find(set.begin(), set.end(), resource) != set.end();
+  };
+  for (const auto& resource : a.writeSet()) {
+    if (contains(b.writeSet(), resource) || contains(b.readSet(), resource)) {
+      return true;
+    }
+  }
+  for (const auto& resource : b.writeSet()) {
+    if (contains(a.readSet(), resource)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace Truffle
@@ -0,0 +1,77 @@
+/**
+ * @file      update_scheduler.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Schedule controller updates onto worker threads
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_UPDATE_SCHEDULER_H
+#define TRUFFLE_UPDATE_SCHEDULER_H
+
+#include <vector>
+
+#include "common/job_pool.h"
+#include "common/non_copyable.h"
+#include "controller.h"
+#include "scene.h"
+
+namespace Truffle {
+
+/**
+ * コントローラーの更新を並行実行できるグループ(ウェーブ)に分割して実行するクラス。
+ * 並行実行を宣言していないコントローラーはすべてのウェーブの後にメインスレッドで
+ * 順番に実行される。
+ */
+class UpdateScheduler : NonCopyable {
+ public:
+  /**
+   * @param worker_count ワーカースレッド数。0であればハードウェアスレッド数に合わせる。
+   */
+  explicit UpdateScheduler(size_t worker_count);
+
+  /**
+   * シーンに属するコントローラーの宣言からウェーブを再構築する
+   * @param scene
+   */
+  void build(const TruffleScene& scene);
+
+  /**
+   * すべてのコントローラーに対して処理を実行する。ウェーブ内のコントローラーは
+   * ワーカースレッドで並行に実行され、ウェーブ間では完了を待ち合わせる。
+   * @param fn
+   */
+  template <class Fn>
+  void run(Fn&& fn);
+
+ private:
+  /**
+   * 二つのコントローラーが共有リソースに競合するアクセスを宣言しているか
+   */
+  static bool conflicts(const TruffleController& a, const TruffleController& b);
+
+  JobPool pool_;
+  std::vector<std::vector<TruffleController*>> waves_;
+  std::vector<TruffleController*> serial_;
+};
+
+template <class Fn>
+void UpdateScheduler::run(Fn&& fn) {
+  for (const auto& wave : waves_) {
+    if (wave.size() == 1) {
+      fn(*wave.front());
+      continue;
+    }
+    for (auto* controller : wave) {
+      pool_.submit([&fn, controller] { fn(*controller); });
+    }
+    pool_.wait();
+  }
+  for (auto* controller : serial_) {
+    fn(*controller);
+  }
+}
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_UPDATE_SCHEDULER_H
@@ -8,79 +8,84 @@
 
 #include "button.h"
 
-#include "wrapper/sdl2/renderer_storage.h"
+#include "engine/render_command.h"
 
 namespace Truffle {
 
-ButtonCallback::ButtonCallback(std::string name) : TruffleVisibleObject(name) {}
+ButtonCallback::ButtonCallback(std::string name) : TruffleVisibleObject(name) {
+  setInteractive(true);
+}
 
-void ButtonCallback::_onButtonPressed(Event& ev) {
-  if (isPressed(ev, state_manager.activeStateObject().renderRect()) &&
+void ButtonCallback::onPointerEnter() {
+  if (state_manager.activeState() == ButtonState::Normal) {
+    Logger::log(LogLevel::INFO, "State changed from Normal to Hovered");
+    transit(ButtonState::Hovered);
+    onMouseHovered();
+  }
+}
+
+void ButtonCallback::onPointerLeave() {
+  if (state_manager.activeState() == ButtonState::Hovered) {
+    Logger::log(LogLevel::INFO, "State changed from Hovered to Normal");
+    transit(ButtonState::Normal);
+    onMouseUnhovered();
+  }
+}
+
+void ButtonCallback::onPointerDown(const SDL_MouseButtonEvent& event) {
+  if (event.button == SDL_BUTTON_LEFT &&
       state_manager.activeState() == ButtonState::Hovered) {
     Logger::log(LogLevel::INFO, "State changed from Hovered to Pressed");
-    state_manager.stateTransition(ButtonState::Pressed);
-    setWidth(state_manager.activeStateObject().renderRect().w);
-    setHeight(state_manager.activeStateObject().renderRect().h);
+    transit(ButtonState::Pressed);
     onButtonPressed();
   }
 }
 
-void ButtonCallback::_onButtonReleased(Event& ev) {
-  if (isReleased(ev, state_manager.activeStateObject().renderRect()) &&
+void ButtonCallback::onPointerUp(const SDL_MouseButtonEvent& event) {
+  if (event.button == SDL_BUTTON_LEFT &&
       state_manager.activeState() == ButtonState::Pressed) {
     Logger::log(LogLevel::INFO, "State changed from Pressed to Hovered");
-    state_manager.stateTransition(ButtonState::Hovered);
-    setWidth(state_manager.activeStateObject().renderRect().w);
-    setHeight(state_manager.activeStateObject().renderRect().h);
+    transit(ButtonState::Hovered);
     onButtonReleased();
   }
 }
 
-void ButtonCallback::_onMouseHovered(Event& ev) {
-  if (isMouseHovered(state_manager.activeStateObject().renderRect()) &&
-      state_manager.activeState() == ButtonState::Normal) {
-    Logger::log(LogLevel::INFO, "State changed from Normal to Hovered");
-    state_manager.stateTransition(ButtonState::Hovered);
-    setWidth(state_manager.activeStateObject().renderRect().w);
-    setHeight(state_manager.activeStateObject().renderRect().h);
-    onMouseHovered();
-  }
-}
-
-void ButtonCallback::_onMouseUnhovered(Event& ev) {
-  if (isMouseUnhovered(state_manager.activeStateObject().renderRect()) &&
-      state_manager.activeState() == ButtonState::Hovered) {
-    Logger::log(LogLevel::INFO, "State changed from Hovered to Normal");
-    state_manager.stateTransition(ButtonState::Normal);
-    setWidth(state_manager.activeStateObject().renderRect().w);
-    setHeight(state_manager.activeStateObject().renderRect().h);
-    onMouseUnhovered();
-  }
+void ButtonCallback::transit(ButtonState state) {
+  state_manager.stateTransition(state);
+  setWidth(state_manager.activeStateObject().renderRect().w);
+  setHeight(state_manager.activeStateObject().renderRect().h);
+  invalidateDrawOrder();
 }
 
-bool ButtonCallback::isMouseHovered(const SDL_Rect& render_rect) {
-  int mouse_x, mouse_y;
-  SDL_GetMouseState(&mouse_x, &mouse_y);
-  return render_rect.x < mouse_x && mouse_x < render_rect.x + render_rect.w &&
-         render_rect.y < mouse_y && mouse_y < render_rect.y + render_rect.h;
+SDL_Texture const* ButtonCallback::drawTexture() const {
+  // activeStateObject() はロックを獲るために非constである
+  auto& manager =
+      const_cast<StatefulObjectManager<Image, ButtonState>&>(state_manager);
+  return manager.activeStateObject().texture().entity();
 }
 
-bool ButtonCallback::isMouseUnhovered(const SDL_Rect& render_rect) {
-  return !isMouseHovered(render_rect);
+size_t ButtonCallback::residentBytes() const {
+  size_t bytes = 0;
+  for (const auto& [_, image] : state_manager.allManagedStatefulObject()) {
+    bytes += image->residentBytes();
+  }
+  return bytes;
 }
 
-bool ButtonCallback::isPressed(Event& ev, const SDL_Rect& render_rect) {
-  if (ev.type == SDL_MOUSEBUTTONDOWN && ev.button.button == SDL_BUTTON_LEFT) {
-    return isMouseHovered(render_rect);
+void ButtonCallback::releaseResources() {
+  for (auto& [_, image] : state_manager.allManagedStatefulObject()) {
+    image->releaseResources();
   }
-  return false;
+  invalidateDrawOrder();
 }
 
-bool ButtonCallback::isReleased(Event& ev, const SDL_Rect& render_rect) {
-  if (ev.type == SDL_MOUSEBUTTONUP && ev.button.button == SDL_BUTTON_LEFT) {
-    return isMouseHovered(render_rect);
+void ButtonCallback::restoreResources() {
+  for (auto& [_, image] : state_manager.allManagedStatefulObject()) {
+    // 状態の画像は描画リストに含まれないので、読み込みの完了をボタンの項目に伝える
+    image->onTextureAdopted([this] { invalidateDrawOrder(); });
+    image->restoreResources();
   }
-  return false;
+  invalidateDrawOrder();
 }
 
 Button::Button(std::string controller_name, std::string object_name, int x,
@@ -109,21 +114,20 @@ Button::Button(std::string controller_name, std::string object_name, int x,
            state_manager.activeStateObject().renderRect().y);
   setWidth(state_manager.activeStateObject().renderRect().w);
   setHeight(state_manager.activeStateObject().renderRect().h);
+}
 
-  // Register event callbacks
-  setEventCallback([this](Event& e) { this->_onMouseHovered(e); });
-  setEventCallback([this](Event& e) { this->_onMouseUnhovered(e); });
-  setEventCallback([this](Event& e) { this->_onButtonReleased(e); });
-  setEventCallback([this](Event& e) { this->_onButtonPressed(e); });
+void Button::render(RenderContext& context) {
+  const auto& texture = state_manager.activeStateObject().texture();
+  if (do_render_ && texture.entity()) {
+    SDL_RenderCopy(context.renderer, const_cast<SDL_Texture*>(texture.entity()),
+                   texture.sourceRect(), &renderRect());
+  }
 }
 
-void Button::render() {
-  if (do_render_) {
-    SDL_RenderCopy(const_cast<SDL_Renderer*>(
-                       RendererStorage::get().activeRenderer()->entity()),
-                   const_cast<SDL_Texture*>(
-                       state_manager.activeStateObject().texture().entity()),
-                   nullptr /* TODO: introduce clip settings */, &renderRect());
+void Button::record(RenderCommandList& commands) {
+  const auto& texture = state_manager.activeStateObject().texture();
+  if (do_render_ && texture.entity()) {
+    commands.copyTexture(texture.entity(), texture.sourceRect(), renderRect());
   }
 }
 
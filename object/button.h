@@ -48,18 +48,27 @@ class ButtonCallback : public TruffleVisibleObject {
    */
   virtual void onMouseUnhovered() = 0;
 
-  void _onButtonPressed(Event& ev);
-  void _onButtonReleased(Event& ev);
-  void _onMouseHovered(Event& ev);
-  void _onMouseUnhovered(Event& ev);
+  // ポインターの入出と押下を状態遷移に変換する
+  void onPointerEnter() override;
+  void onPointerLeave() override;
+  void onPointerDown(const SDL_MouseButtonEvent& event) override;
+  void onPointerUp(const SDL_MouseButtonEvent& event) override;
+
+  [[nodiscard]] SDL_Texture const* drawTexture() const override;
+
+  // 常駐管理。すべての状態の画像に対して行う
+  [[nodiscard]] size_t residentBytes() const override;
+  void releaseResources() override;
+  void restoreResources() override;
 
   StatefulObjectManager<Image, ButtonState> state_manager;
 
  private:
-  bool isMouseHovered(const SDL_Rect& render_rect);
-  bool isMouseUnhovered(const SDL_Rect& render_rect);
-  bool isPressed(Event& ev, const SDL_Rect& render_rect);
-  bool isReleased(Event& ev, const SDL_Rect& render_rect);
+  /**
+   * 状態を遷移させ、描画範囲とテクスチャの変化を描画リストに通知する
+   * @param state
+   */
+  void transit(ButtonState state);
 };
 
 /**
@@ -83,7 +92,8 @@ class Button : public Actor, public ButtonCallback {
          std::string path_pressed = "");
 
   // Renderable
-  void render() override final;
+  void render(RenderContext& context) override final;
+  void record(RenderCommandList& commands) override final;
 
   // ButtonEventCallback
   virtual void onButtonPressed() override {}
@@ -8,23 +8,83 @@
 
 #include "image.h"
 
-#include "wrapper/sdl2/renderer_storage.h"
+#include <utility>
+
+#include "engine/render_command.h"
 
 namespace Truffle {
 
 Image::Image(std::string name, std::string path, int x, int y)
-    : TruffleVisibleObject(name), texture_(path) {
+    : TruffleVisibleObject(name), texture_(path), path_(std::move(path)) {
   setPoint(x, y);
   setWidth(texture_.width());
   setHeight(texture_.height());
 }
 
-void Image::render() {
-  if (do_render_) {
-    SDL_RenderCopy(const_cast<SDL_Renderer*>(
-                       RendererStorage::get().activeRenderer()->entity()),
-                   const_cast<SDL_Texture*>(texture_.entity()), nullptr,
-                   &renderRect());
+Image::Image(std::string name, AsyncTexture texture, int x, int y,
+             const std::string& placeholder_path)
+    : TruffleVisibleObject(name),
+      loading_(std::move(texture)),
+      path_(loading_.path()),
+      options_(loading_.options()) {
+  setPoint(x, y);
+  if (!placeholder_path.empty()) {
+    texture_ = Texture(placeholder_path);
+    setWidth(texture_.width());
+    setHeight(texture_.height());
+  }
+  loading_.onComplete([this] { adopt(); });
+}
+
+Image::~Image() { loading_.cancel(); }
+
+void Image::adopt() {
+  if (loading_.ready()) {
+    texture_ = Texture(loading_.texture());
+    setWidth(texture_.width());
+    setHeight(texture_.height());
+    invalidateDrawOrder();
+    if (on_adopted_) {
+      on_adopted_();
+    }
+  } else {
+    // 失敗した場合は代わりの画像を表示し続ける
+    path_.clear();
+  }
+  loading_ = AsyncTexture();
+}
+
+void Image::releaseResources() {
+  // アトラスの一部と読み込み中の画像は解放しない
+  if (path_.empty() || loading_.valid() || !texture_.cached()) {
+    return;
+  }
+  texture_ = Texture();
+  released_ = true;
+  invalidateDrawOrder();
+}
+
+void Image::restoreResources() {
+  if (!released_) {
+    return;
+  }
+  released_ = false;
+  loading_ = TextureLoader::load(path_, options_);
+  loading_.onComplete([this] { adopt(); });
+}
+
+void Image::render(RenderContext& context) {
+  if (do_render_ && texture_.entity()) {
+    SDL_RenderCopy(context.renderer,
+                   const_cast<SDL_Texture*>(texture_.entity()),
+                   texture_.sourceRect(), &renderRect());
+  }
+}
+
+void Image::record(RenderCommandList& commands) {
+  if (do_render_ && texture_.entity()) {
+    commands.copyTexture(texture_.entity(), texture_.sourceRect(),
+                         renderRect());
   }
 }
 
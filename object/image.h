@@ -9,8 +9,13 @@
 #ifndef TRUFFLE_IMAGE_H
 #define TRUFFLE_IMAGE_H
 
+#include <functional>
+#include <string>
+#include <utility>
+
 #include "engine/object.h"
 #include "wrapper/sdl2/texture.h"
+#include "wrapper/sdl2/texture_loader.h"
 
 namespace Truffle {
 
@@ -18,12 +23,59 @@ class Image : public TruffleVisibleObject {
  public:
   Image(std::string name, std::string path, int x, int y);
 
-  void render() final;
+  /**
+   * 非同期に読み込んでいる画像を表示する。読み込みが完了するまでは代わりの画像を
+   * 表示し、完了した時点で画像の大きさに合わせる。
+   * @param name
+   * @param texture TextureLoader::load() の結果
+   * @param x
+   * @param y
+   * @param placeholder_path 読み込み中に表示する画像。同期的に読み込むので、小さいもの
+   * かアトラスに詰め込んだものを用いること。空であれば何も表示しない
+   */
+  Image(std::string name, AsyncTexture texture, int x, int y,
+        const std::string& placeholder_path = "");
+  ~Image();
+
+  void render(RenderContext& context) final;
+  void record(RenderCommandList& commands) final;
+  [[nodiscard]] SDL_Texture const* drawTexture() const final {
+    return texture_.entity();
+  }
+
+  // 常駐管理
+  [[nodiscard]] size_t residentBytes() const final { return texture_.bytes(); }
+  void releaseResources() final;
+  void restoreResources() final;
 
   [[nodiscard]] const Texture& texture() const& { return texture_; }
 
+  /**
+   * 非同期に読み込んでいる画像がまだ表示されていないか
+   * @return
+   */
+  [[nodiscard]] bool loading() const { return loading_.valid(); }
+
+  /**
+   * 非同期に読み込んだ画像に差し替えた時に呼ぶ関数を設定する。この画像を描画する
+   * 別のオブジェクトが、自身の描画リストの項目を更新するために用いる。
+   * @param callback
+   */
+  void onTextureAdopted(std::function<void()> callback) {
+    on_adopted_ = std::move(callback);
+  }
+
  private:
+  // 読み込みが完了した画像に差し替える
+  void adopt();
+
   Texture texture_;
+  AsyncTexture loading_;
+  // 読み込み直す際の画像のパス。読み込みに失敗していれば空
+  std::string path_;
+  TextureLoadOptions options_;
+  std::function<void()> on_adopted_;
+  bool released_ = false;
 };
 
 }  // namespace Truffle
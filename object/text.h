@@ -10,7 +10,7 @@
 #define TRUFFLE_TEXT_H
 
 #include "engine/object.h"
-#include "wrapper/sdl2/renderer_storage.h"
+#include "engine/render_command.h"
 #include "wrapper/sdl2/texture.h"
 
 namespace Truffle {
@@ -21,7 +21,11 @@ class SolidText : public TruffleVisibleObject {
             std::string font, size_t font_size);
 
   void setText(std::string text);
-  void render() final;
+  void render(RenderContext& context) final;
+  void record(RenderCommandList& commands) final;
+  [[nodiscard]] SDL_Texture const* drawTexture() const final {
+    return texture_.entity();
+  }
 
  private:
   Texture texture_;
@@ -43,21 +47,28 @@ SolidText::SolidText(std::string name, std::string text, int x, int y,
 }
 
 void SolidText::setText(std::string text) {
-  auto new_texture =
+  texture_ =
       Texture(text, TextTextureMode::Solid,
               FontInfo{default_font_size_, default_font_}, default_color_);
-  texture_ = new_texture;
+  setWidth(texture_.width());
+  setHeight(texture_.height());
+  invalidateDrawOrder();
 }
 
-void SolidText::render() {
+void SolidText::render(RenderContext& context) {
   if (do_render_) {
-    SDL_RenderCopy(const_cast<SDL_Renderer*>(
-                       RendererStorage::get().activeRenderer()->entity()),
+    SDL_RenderCopy(context.renderer,
                    const_cast<SDL_Texture*>(texture_.entity()), nullptr,
                    &renderRect());
   }
 }
 
+void SolidText::record(RenderCommandList& commands) {
+  if (do_render_) {
+    commands.copyTexture(texture_.entity(), nullptr, renderRect());
+  }
+}
+
 }  // namespace Truffle
 
 #endif  // TRUFFLE_TEXT_H
@@ -0,0 +1,160 @@
+/**
+ * @file      truffle_pack.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Offline packer that writes pre-decoded images into an asset pack
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_Image.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_format.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "wrapper/sdl2/asset_pack.h"
+
+using Truffle::AssetPackEntry;
+using Truffle::AssetPackHeader;
+using Truffle::TruffleException;
+
+namespace {
+
+struct SurfaceDeleter {
+  void operator()(SDL_Surface* surface) const { SDL_FreeSurface(surface); }
+};
+
+using SurfacePtr = std::unique_ptr<SDL_Surface, SurfaceDeleter>;
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+void pad(std::ofstream& out, uint64_t offset) {
+  static const char zeros[Truffle::ASSET_PACK_PIXEL_ALIGNMENT] = {};
+  const auto current = static_cast<uint64_t>(out.tellp());
+  out.write(zeros, static_cast<std::streamsize>(offset - current));
+}
+
+SurfacePtr loadRGBA(const std::string& path) {
+  SurfacePtr loaded(IMG_Load(path.c_str()));
+  if (!loaded) {
+    throw TruffleException(
+        absl::StrFormat("Failed to load image: %s: %s", path, IMG_GetError()));
+  }
+  SurfacePtr converted(
+      SDL_ConvertSurfaceFormat(loaded.get(), SDL_PIXELFORMAT_RGBA32, 0));
+  if (!converted) {
+    throw TruffleException(
+        absl::StrFormat("Failed to convert image: %s", path));
+  }
+  return converted;
+}
+
+/**
+ * 画像を展開してパックに書き出す。画像の名前は与えられたパスそのものになるので、
+ * 実行時に Texture に与えるパスと同じ作業ディレクトリで実行すること。
+ * @param output
+ * @param paths
+ * @return 書き出した画像の数
+ */
+size_t writePack(const std::string& output,
+                 const std::vector<std::string>& paths) {
+  std::ofstream out(output, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw TruffleException(absl::StrFormat("Failed to open %s", output));
+  }
+
+  AssetPackHeader header{};
+  std::memcpy(header.magic, Truffle::ASSET_PACK_MAGIC, sizeof(header.magic));
+  header.version = Truffle::ASSET_PACK_VERSION;
+  header.alignment = Truffle::ASSET_PACK_PIXEL_ALIGNMENT;
+  // 索引の位置は画素列を書き終えるまで分からないので、後で書き直す
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<AssetPackEntry> entries;
+  std::string names;
+  absl::flat_hash_set<std::string> seen;
+  for (const auto& path : paths) {
+    if (!seen.insert(path).second) {
+      continue;
+    }
+    const auto surface = loadRGBA(path);
+
+    AssetPackEntry entry{};
+    entry.name_offset = names.size();
+    entry.name_length = static_cast<uint32_t>(path.size());
+    entry.width = static_cast<uint32_t>(surface->w);
+    entry.height = static_cast<uint32_t>(surface->h);
+    entry.pitch = entry.width * 4;
+    entry.data_offset = alignUp(static_cast<uint64_t>(out.tellp()),
+                                Truffle::ASSET_PACK_PIXEL_ALIGNMENT);
+    pad(out, entry.data_offset);
+
+    // 変換後のサーフェスは行末に余白を持つことがあるので1行ずつ書く
+    SDL_LockSurface(surface.get());
+    const auto* pixels = static_cast<const char*>(surface->pixels);
+    for (int y = 0; y < surface->h; ++y) {
+      out.write(pixels + static_cast<ptrdiff_t>(y) * surface->pitch,
+                entry.pitch);
+    }
+    SDL_UnlockSurface(surface.get());
+
+    names += path;
+    entries.emplace_back(entry);
+  }
+
+  header.entry_count = static_cast<uint32_t>(entries.size());
+  header.index_offset =
+      alignUp(static_cast<uint64_t>(out.tellp()), alignof(AssetPackEntry));
+  pad(out, header.index_offset);
+  out.write(reinterpret_cast<const char*>(entries.data()),
+            static_cast<std::streamsize>(entries.size() *
+                                         sizeof(AssetPackEntry)));
+  header.names_offset = static_cast<uint64_t>(out.tellp());
+  out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!out) {
+    throw TruffleException(absl::StrFormat("Failed to write %s", output));
+  }
+  return entries.size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0] << " <output.pack> <image>..."
+              << std::endl;
+    return 1;
+  }
+  if (!(IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) & IMG_INIT_PNG)) {
+    std::cerr << "Failed to init SDL_image: " << IMG_GetError() << std::endl;
+    return 1;
+  }
+
+  const std::vector<std::string> paths(argv + 2, argv + argc);
+  size_t packed = 0;
+  try {
+    packed = writePack(argv[1], paths);
+  } catch (const TruffleException& e) {
+    std::cerr << e.what() << std::endl;
+    IMG_Quit();
+    return 1;
+  }
+  std::cout << absl::StrFormat("packed %d images into %s", packed, argv[1])
+            << std::endl;
+  IMG_Quit();
+  return 0;
+}
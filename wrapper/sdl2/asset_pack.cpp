@@ -0,0 +1,135 @@
+/**
+ * @file      asset_pack.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Memory-mapped archive of pre-decoded RGBA images
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "asset_pack.h"
+
+#include <SDL2/SDL_Image.h>
+#include <absl/strings/str_format.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/trace.h"
+
+namespace Truffle {
+
+AssetPack::AssetPack(const std::string& path) : path_(path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw TruffleException(
+        absl::StrFormat("Failed to open asset pack: %s", path));
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(AssetPackHeader)) {
+    close(fd);
+    throw TruffleException(absl::StrFormat("Invalid asset pack: %s", path));
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // マップした後はファイルを閉じてよい
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw TruffleException(
+        absl::StrFormat("Failed to map asset pack: %s", path));
+  }
+  data_ = static_cast<const uint8_t*>(mapped);
+
+  try {
+    const auto* header = reinterpret_cast<const AssetPackHeader*>(data_);
+    if (std::memcmp(header->magic, ASSET_PACK_MAGIC, sizeof(header->magic)) !=
+            0 ||
+        header->version != ASSET_PACK_VERSION) {
+      throw TruffleException(
+          absl::StrFormat("Unsupported asset pack: %s", path));
+    }
+    const auto index_bytes =
+        static_cast<uint64_t>(header->entry_count) * sizeof(AssetPackEntry);
+    if (header->index_offset % alignof(AssetPackEntry) != 0 ||
+        header->index_offset > size_ ||
+        index_bytes > size_ - header->index_offset ||
+        header->names_offset > size_) {
+      throw TruffleException(
+          absl::StrFormat("Corrupted asset pack index: %s", path));
+    }
+
+    const auto* entries =
+        reinterpret_cast<const AssetPackEntry*>(data_ + header->index_offset);
+    const auto* names =
+        reinterpret_cast<const char*>(data_ + header->names_offset);
+    const auto names_size = size_ - header->names_offset;
+    index_.reserve(header->entry_count);
+    for (uint32_t i = 0; i < header->entry_count; ++i) {
+      const auto& entry = entries[i];
+      const auto pixel_bytes =
+          static_cast<uint64_t>(entry.pitch) * entry.height;
+      if (entry.name_offset > names_size ||
+          entry.name_length > names_size - entry.name_offset ||
+          entry.pitch < static_cast<uint64_t>(entry.width) * 4 ||
+          entry.data_offset % 4 != 0 || entry.data_offset > size_ ||
+          pixel_bytes > size_ - entry.data_offset) {
+        throw TruffleException(
+            absl::StrFormat("Corrupted asset pack entry %d: %s", i, path));
+      }
+      index_.emplace(
+          std::string_view(names + entry.name_offset, entry.name_length),
+          &entry);
+    }
+  } catch (...) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    throw;
+  }
+}
+
+AssetPack::~AssetPack() {
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+const AssetPackEntry* AssetPack::find(std::string_view name) const {
+  const auto it = index_.find(name);
+  return it == index_.end() ? nullptr : it->second;
+}
+
+SDL_Surface* AssetPack::createSurface(const AssetPackEntry& entry) const {
+  // SDL はプリアロケートされた画素列を書き換えないので、読み込み専用のマップを渡せる
+  return SDL_CreateRGBSurfaceWithFormatFrom(
+      const_cast<uint8_t*>(data_ + entry.data_offset),
+      static_cast<int>(entry.width), static_cast<int>(entry.height), 32,
+      static_cast<int>(entry.pitch), SDL_PIXELFORMAT_RGBA32);
+}
+
+void AssetPackStorage::mount_(const std::string& path) {
+  auto pack = std::make_unique<AssetPack>(path);
+  Logger::log(LogLevel::INFO,
+              absl::StrFormat("asset pack %s mounted with %d images", path,
+                              pack->entryCount()));
+  std::unique_lock<std::mutex> l(mux_);
+  packs_.emplace_back(std::move(pack));
+}
+
+SDL_Surface* AssetPackStorage::loadSurface_(const std::string& path) {
+  {
+    std::unique_lock<std::mutex> l(mux_);
+    for (auto it = packs_.rbegin(); it != packs_.rend(); ++it) {
+      if (const auto* entry = (*it)->find(path)) {
+        return (*it)->createSurface(*entry);
+      }
+    }
+  }
+  TRUFFLE_TRACE_ZONE("AssetPackStorage::decode");
+  return IMG_Load(path.c_str());
+}
+
+}  // namespace Truffle
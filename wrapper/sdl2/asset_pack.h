@@ -0,0 +1,145 @@
+/**
+ * @file      asset_pack.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Memory-mapped archive of pre-decoded RGBA images
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_ASSET_PACK_H
+#define TRUFFLE_ASSET_PACK_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/non_copyable.h"
+#include "common/singleton.h"
+
+namespace Truffle {
+
+/**
+ * パックのファイル形式。値はパックを作成したホストのバイト順で格納するので、
+ * 同じバイト順の環境で読み込むこと。
+ *
+ * | AssetPackHeader | 画素列... | AssetPackEntry × entry_count | 名前の列 |
+ *
+ * 画素列は SDL_PIXELFORMAT_RGBA32 で展開済みの画像であり、先頭を
+ * ASSET_PACK_PIXEL_ALIGNMENT に揃える。名前は終端文字を含まない。
+ */
+struct AssetPackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t alignment;
+  // AssetPackEntry の配列の位置
+  uint64_t index_offset;
+  // 名前の列の位置
+  uint64_t names_offset;
+};
+
+struct AssetPackEntry {
+  // 名前の列の先頭からの位置
+  uint64_t name_offset;
+  uint32_t name_length;
+  uint32_t width;
+  uint32_t height;
+  // 1行のバイト数
+  uint32_t pitch;
+  // ファイルの先頭からの画素列の位置
+  uint64_t data_offset;
+};
+
+static_assert(sizeof(AssetPackHeader) == 32);
+static_assert(sizeof(AssetPackEntry) == 32);
+
+constexpr char ASSET_PACK_MAGIC[4] = {'T', 'R', 'P', 'K'};
+constexpr uint32_t ASSET_PACK_VERSION = 1;
+// 画素列の先頭を揃える境界(バイト)
+constexpr uint32_t ASSET_PACK_PIXEL_ALIGNMENT = 64;
+
+/**
+ * パックをメモリにマップし、画素列をコピーせずに参照するクラス。画像の展開を
+ * 起動時に行わずに済む。
+ */
+class AssetPack : NonCopyable {
+ public:
+  /**
+   * パックを開く。形式が不正であれば例外を返す。
+   * @param path
+   */
+  explicit AssetPack(const std::string& path);
+  ~AssetPack();
+
+  /**
+   * 名前に一致する画像を探す
+   * @param name パックを作成した際に与えたパス
+   * @return 存在しなければnullptr
+   */
+  [[nodiscard]] const AssetPackEntry* find(std::string_view name) const;
+
+  /**
+   * 画像の画素列を参照するサーフェスを生成する。画素列はコピーしないので、パックより
+   * 先に SDL_FreeSurface() すること。
+   * @param entry
+   * @return
+   */
+  [[nodiscard]] SDL_Surface* createSurface(const AssetPackEntry& entry) const;
+
+  [[nodiscard]] const std::string& path() const& { return path_; }
+  [[nodiscard]] size_t entryCount() const { return index_.size(); }
+
+ private:
+  std::string path_;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  absl::flat_hash_map<std::string_view, const AssetPackEntry*> index_;
+};
+
+/**
+ * マウントしたパックを保持し、画像の読み込みをパックとファイルのどちらからでも
+ * 行えるようにするクラス。パックは終了まで解放しない。
+ */
+class AssetPackStorage : public MutableSingleton<AssetPackStorage>,
+                         NonCopyable {
+ public:
+  /**
+   * パックをマウントする。後からマウントしたパックの画像を優先する。
+   * @param path
+   */
+  static void mount(const std::string& path) {
+    AssetPackStorage::get().mount_(path);
+  }
+
+  /**
+   * 画像を読み込む。マウントしたパックに同じ名前の画像があればその画素列を参照し、
+   * なければファイルを展開する。どのスレッドからでも呼べる。
+   * @param path パックの画像の名前もしくはファイルのパス
+   * @return 失敗した場合はnullptr。理由は SDL_GetError() で得られる
+   */
+  static SDL_Surface* loadSurface(const std::string& path) {
+    return AssetPackStorage::get().loadSurface_(path);
+  }
+
+ private:
+  friend class MutableSingleton<AssetPackStorage>;
+
+  AssetPackStorage() = default;
+
+  void mount_(const std::string& path);
+  SDL_Surface* loadSurface_(const std::string& path);
+
+  std::mutex mux_;
+  std::vector<std::unique_ptr<AssetPack>> packs_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_ASSET_PACK_H
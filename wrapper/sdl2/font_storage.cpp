@@ -8,6 +8,8 @@
 
 #include "font_storage.h"
 
+#include "common/trace.h"
+
 namespace Truffle {
 
 FontStorage::FontStorage() {
@@ -19,6 +21,7 @@ FontStorage::FontStorage() {
 }
 
 std::shared_ptr<Font> FontStorage::openFont_(std::string name, size_t size) {
+  TRUFFLE_TRACE_ZONE("FontStorage::openFont");
   if (loaded_font_.find(name) == loaded_font_.end()) {
     throw TruffleException(
         absl::StrFormat("Font %s must be loaded before open", name));
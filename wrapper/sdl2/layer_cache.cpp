@@ -0,0 +1,95 @@
+/**
+ * @file      layer_cache.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Render target textures holding pre-rendered static layers
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "layer_cache.h"
+
+#include <absl/strings/str_format.h>
+
+#include <cassert>
+
+#include "common/logger.h"
+#include "texture.h"
+
+namespace Truffle {
+
+namespace {
+
+// 透明なテクスチャにブレンドして描画した結果は色にアルファが乗算済みになるので、
+// 合成時は乗算済みアルファとしてブレンドする
+SDL_BlendMode premultipliedBlendMode() {
+  return SDL_ComposeCustomBlendMode(
+      SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+      SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE,
+      SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+}
+
+}  // namespace
+
+bool LayerCache::begin(SDL_Renderer* renderer, size_t slot) {
+  assert(!active_);
+  int width = 0;
+  int height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  if (slots_.size() <= slot) {
+    slots_.resize(slot + 1);
+  }
+
+  auto& cache = slots_[slot];
+  if (!cache.texture || cache.width != width || cache.height != height) {
+    if (cache.texture) {
+      TextureReaper::retire(cache.texture);
+      cache = Slot{};
+    }
+    auto* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                      SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture) {
+      Logger::log(LogLevel::WARN,
+                  absl::StrFormat("Failed to create static layer cache, "
+                                  "falls back to per-frame drawing: %s",
+                                  SDL_GetError()));
+      available_ = false;
+      return false;
+    }
+    // 乗算済みアルファに対応しないレンダラーでは通常のブレンドで近似する
+    if (SDL_SetTextureBlendMode(texture, premultipliedBlendMode()) != 0) {
+      SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+    cache = Slot{texture, width, height};
+  }
+
+  previous_target_ = SDL_GetRenderTarget(renderer);
+  previous_clip_enabled_ = SDL_RenderIsClipEnabled(renderer) == SDL_TRUE;
+  SDL_RenderGetClipRect(renderer, &previous_clip_);
+
+  SDL_SetRenderTarget(renderer, cache.texture);
+  SDL_RenderSetClipRect(renderer, nullptr);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+  active_ = true;
+  return true;
+}
+
+void LayerCache::end(SDL_Renderer* renderer) {
+  if (!active_) {
+    return;
+  }
+  SDL_SetRenderTarget(renderer, previous_target_);
+  SDL_RenderSetClipRect(renderer,
+                        previous_clip_enabled_ ? &previous_clip_ : nullptr);
+  previous_target_ = nullptr;
+  active_ = false;
+}
+
+void LayerCache::composite(SDL_Renderer* renderer, size_t slot) const {
+  if (slots_.size() <= slot || !slots_[slot].texture) {
+    return;
+  }
+  SDL_RenderCopy(renderer, slots_[slot].texture, nullptr, nullptr);
+}
+
+}  // namespace Truffle
@@ -0,0 +1,75 @@
+/**
+ * @file      layer_cache.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Render target textures holding pre-rendered static layers
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_LAYER_CACHE_H
+#define TRUFFLE_LAYER_CACHE_H
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "common/non_copyable.h"
+
+namespace Truffle {
+
+/**
+ * 静止しているオブジェクトの描画結果を保持する描画先テクスチャの集合。スロット毎に
+ * 描画先と同じ大きさの透明なテクスチャを持ち、一度描画した内容を1回のコピーで合成する。
+ * メインスレッドから使うこと。
+ */
+class LayerCache : NonCopyable {
+ public:
+  /**
+   * 描画先をスロットのテクスチャに切り替えて透明に消去する。テクスチャがなければ
+   * 描画先と同じ大きさで作成する。
+   * @param renderer
+   * @param slot
+   * @return テクスチャを作成できなかった場合はfalse。描画先は切り替わらない
+   */
+  bool begin(SDL_Renderer* renderer, size_t slot);
+
+  /**
+   * begin() の前の描画先とクリップ矩形に戻す。begin() が失敗していれば何もしない。
+   * @param renderer
+   */
+  void end(SDL_Renderer* renderer);
+
+  /**
+   * スロットの内容を描画先全体に合成する
+   * @param renderer
+   * @param slot
+   */
+  void composite(SDL_Renderer* renderer, size_t slot) const;
+
+  /**
+   * キャッシュを使用できるか。テクスチャの作成に失敗するとfalseになる。
+   * シミュレーションスレッドから参照してよい。
+   * @return
+   */
+  [[nodiscard]] bool available() const { return available_.load(); }
+
+ private:
+  struct Slot {
+    SDL_Texture* texture = nullptr;
+    int width = 0;
+    int height = 0;
+  };
+
+  std::vector<Slot> slots_;
+  std::atomic<bool> available_ = true;
+  bool active_ = false;
+  SDL_Texture* previous_target_ = nullptr;
+  bool previous_clip_enabled_ = false;
+  SDL_Rect previous_clip_{};
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_LAYER_CACHE_H
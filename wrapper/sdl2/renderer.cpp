@@ -14,10 +14,9 @@
 
 namespace Truffle {
 
-Renderer::Renderer(const Window& window) {
+Renderer::Renderer(const Window& window, uint32_t flags) {
   renderer_entity_ =
-      SDL_CreateRenderer(const_cast<SDL_Window*>(window.entity()), -1,
-                         SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+      SDL_CreateRenderer(const_cast<SDL_Window*>(window.entity()), -1, flags);
   if (!renderer_entity_) {
     throw TruffleException(absl::StrFormat(
         "Failed to create renderer, bound to window %s", window.name()));
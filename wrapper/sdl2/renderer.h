@@ -30,7 +30,9 @@ class Renderer : public MutableSingleton<Renderer>, NonCopyable {
  private:
   friend class MutableSingleton<Renderer>;
 
-  explicit Renderer(const Window& window);
+  explicit Renderer(const Window& window,
+                    uint32_t flags = SDL_RENDERER_ACCELERATED |
+                                     SDL_RENDERER_PRESENTVSYNC);
 
   SDL_Renderer* renderer_entity_;
 };
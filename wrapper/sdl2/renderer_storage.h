@@ -25,8 +25,10 @@ class RendererStorage : public MutableSingleton<RendererStorage>, NonCopyable {
     return RendererStorage::get().activeRenderer_();
   }
 
-  static void activateRenderer(const Window& window) {
-    RendererStorage::get().activateRenderer_(window);
+  static void activateRenderer(
+      const Window& window,
+      uint32_t flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC) {
+    RendererStorage::get().activateRenderer_(window, flags);
   }
 
  private:
@@ -39,9 +41,9 @@ class RendererStorage : public MutableSingleton<RendererStorage>, NonCopyable {
     return renderer_;
   }
 
-  void activateRenderer_(const Window& window) {
+  void activateRenderer_(const Window& window, uint32_t flags) {
     if (!renderer_) {
-      renderer_ = std::shared_ptr<Renderer>(&Renderer::get(window));
+      renderer_ = std::shared_ptr<Renderer>(&Renderer::get(window, flags));
     }
   }
 
@@ -0,0 +1,99 @@
+/**
+ * @file      sprite_batcher.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Batch textured quads into SDL_RenderGeometry calls
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "sprite_batcher.h"
+
+#include <cassert>
+
+namespace Truffle {
+
+void SpriteBatcher::begin(SDL_Renderer* renderer) {
+  assert(quads_.empty());
+  renderer_ = renderer;
+  texture_ = nullptr;
+  draw_calls_ = 0;
+  sprites_ = 0;
+}
+
+void SpriteBatcher::draw(SDL_Texture* texture, const SDL_Rect* src,
+                         const SDL_Rect& dst) {
+  assert(renderer_ != nullptr);
+  SDL_BlendMode blend_mode;
+  SDL_Color color_mod;
+  SDL_GetTextureBlendMode(texture, &blend_mode);
+  SDL_GetTextureColorMod(texture, &color_mod.r, &color_mod.g, &color_mod.b);
+  SDL_GetTextureAlphaMod(texture, &color_mod.a);
+  if (texture != texture_ || blend_mode != blend_mode_ ||
+      color_mod.r != color_mod_.r || color_mod.g != color_mod_.g ||
+      color_mod.b != color_mod_.b || color_mod.a != color_mod_.a) {
+    flush();
+    texture_ = texture;
+    blend_mode_ = blend_mode;
+    color_mod_ = color_mod;
+    SDL_QueryTexture(texture, nullptr, nullptr, &texture_width_,
+                     &texture_height_);
+  }
+  quads_.emplace_back(
+      Quad{src ? *src : SDL_Rect{0, 0, texture_width_, texture_height_}, dst});
+  ++sprites_;
+}
+
+void SpriteBatcher::flush() {
+  if (quads_.empty()) {
+    return;
+  }
+  // SDL_RenderGeometry に対応していないレンダラーでは1枚ずつ描画する
+  if (!TRUFFLE_HAS_RENDER_GEOMETRY || quads_.size() == 1 || !flushGeometry()) {
+    for (const auto& quad : quads_) {
+      SDL_RenderCopy(renderer_, texture_, &quad.src, &quad.dst);
+      ++draw_calls_;
+    }
+  }
+  quads_.clear();
+}
+
+bool SpriteBatcher::flushGeometry() {
+#if TRUFFLE_HAS_RENDER_GEOMETRY
+  vertices_.clear();
+  indices_.clear();
+  const auto u_scale = 1.0f / static_cast<float>(texture_width_);
+  const auto v_scale = 1.0f / static_cast<float>(texture_height_);
+
+  for (const auto& [src, dst] : quads_) {
+    const auto base = static_cast<int>(vertices_.size());
+    const auto left = static_cast<float>(dst.x);
+    const auto top = static_cast<float>(dst.y);
+    const auto right = static_cast<float>(dst.x + dst.w);
+    const auto bottom = static_cast<float>(dst.y + dst.h);
+    const auto u0 = static_cast<float>(src.x) * u_scale;
+    const auto v0 = static_cast<float>(src.y) * v_scale;
+    const auto u1 = static_cast<float>(src.x + src.w) * u_scale;
+    const auto v1 = static_cast<float>(src.y + src.h) * v_scale;
+
+    vertices_.emplace_back(SDL_Vertex{{left, top}, color_mod_, {u0, v0}});
+    vertices_.emplace_back(SDL_Vertex{{right, top}, color_mod_, {u1, v0}});
+    vertices_.emplace_back(SDL_Vertex{{right, bottom}, color_mod_, {u1, v1}});
+    vertices_.emplace_back(SDL_Vertex{{left, bottom}, color_mod_, {u0, v1}});
+    for (const auto offset : {0, 1, 2, 0, 2, 3}) {
+      indices_.emplace_back(base + offset);
+    }
+  }
+
+  if (SDL_RenderGeometry(renderer_, texture_, vertices_.data(),
+                         static_cast<int>(vertices_.size()), indices_.data(),
+                         static_cast<int>(indices_.size())) != 0) {
+    return false;
+  }
+  ++draw_calls_;
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace Truffle
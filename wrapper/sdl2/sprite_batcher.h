@@ -0,0 +1,103 @@
+/**
+ * @file      sprite_batcher.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Batch textured quads into SDL_RenderGeometry calls
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_SPRITE_BATCHER_H
+#define TRUFFLE_SPRITE_BATCHER_H
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "common/non_copyable.h"
+
+// SDL_RenderGeometry は SDL 2.0.18 以降でのみ利用できる
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define TRUFFLE_HAS_RENDER_GEOMETRY 1
+#else
+#define TRUFFLE_HAS_RENDER_GEOMETRY 0
+#endif
+
+namespace Truffle {
+
+/**
+ * 同じテクスチャを連続して描画する矩形をまとめ、1回の描画呼び出しで描画するクラス。
+ * 描画順を保つため、テクスチャもしくはブレンドモード、カラーモジュレーションが変わった時点で
+ * それまでの矩形を描画する。
+ * メインスレッドから使うこと。
+ */
+class SpriteBatcher : NonCopyable {
+ public:
+  /**
+   * フレームの描画を開始する。前のフレームの統計はリセットされる。
+   * @param renderer 描画先
+   */
+  void begin(SDL_Renderer* renderer);
+
+  /**
+   * テクスチャの矩形を描画先の矩形に描画する。実際の描画は flush() まで遅延される。
+   * @param texture
+   * @param src テクスチャ内の矩形。nullptrであればテクスチャ全体
+   * @param dst 描画先の矩形
+   */
+  void draw(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect& dst);
+
+  /**
+   * 溜まっている矩形をすべて描画する。バッチャーを経由せずに描画する前に呼ぶこと。
+   */
+  void flush();
+
+  /**
+   * begin() 以降に発行した描画呼び出しの回数
+   * @return
+   */
+  [[nodiscard]] uint32_t drawCalls() const { return draw_calls_; }
+
+  /**
+   * begin() 以降に描画した矩形の数
+   * @return
+   */
+  [[nodiscard]] uint32_t sprites() const { return sprites_; }
+
+  /**
+   * begin() で指定された描画先
+   * @return
+   */
+  [[nodiscard]] SDL_Renderer* renderer() const { return renderer_; }
+
+ private:
+  struct Quad {
+    SDL_Rect src;
+    SDL_Rect dst;
+  };
+
+  // 描画に失敗した場合はfalseを返す
+  bool flushGeometry();
+
+  SDL_Renderer* renderer_ = nullptr;
+  SDL_Texture* texture_ = nullptr;
+  SDL_BlendMode blend_mode_ = SDL_BLENDMODE_NONE;
+  // SDL_RenderGeometry はテクスチャのカラー/アルファモジュレーションを使わないので、
+  // 頂点色に含める
+  SDL_Color color_mod_{0xff, 0xff, 0xff, 0xff};
+  int texture_width_ = 0;
+  int texture_height_ = 0;
+
+  std::vector<Quad> quads_;
+#if TRUFFLE_HAS_RENDER_GEOMETRY
+  std::vector<SDL_Vertex> vertices_;
+  std::vector<int> indices_;
+#endif
+
+  uint32_t draw_calls_ = 0;
+  uint32_t sprites_ = 0;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_SPRITE_BATCHER_H
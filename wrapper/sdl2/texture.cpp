@@ -8,41 +8,47 @@
 
 #include "texture.h"
 
-#include <SDL2/SDL_Image.h>
 #include <SDL2/SDL_ttf.h>
 #include <absl/strings/str_format.h>
 
+#include <utility>
+
 #include "common/exception.h"
+#include "common/trace.h"
 #include "font_storage.h"
 #include "renderer_storage.h"
+#include "texture_atlas.h"
 
 namespace Truffle {
 
-Texture::Texture(std::string path) {
-  SDL_Surface* surface = IMG_Load(path.c_str());
-  if (!surface) {
-    throw TruffleException(
-        absl::StrFormat("Failed to load image: %s", path.c_str()));
-  }
-
-  texture_ = SDL_CreateTextureFromSurface(
-      const_cast<SDL_Renderer*>(
-          RendererStorage::get().activeRenderer()->entity()),
-      surface);
-
-  if (!texture_) {
-    throw TruffleException(absl::StrFormat(
-        "Failed to create texture entity from %s", path.c_str()));
+Texture::Texture(std::string path, const TextureLoadOptions& options) {
+  TRUFFLE_TRACE_ZONE("Texture::load");
+  // アトラスのテクスチャは共有されているので、既定の設定でのみ用いる
+  if (auto entry = TextureAtlas::find(path);
+      entry.has_value() && options == TextureLoadOptions{}) {
+    page_ = std::move(entry->page);
+    source_ = entry->rect;
+    texture_ = page_->entity();
+    width_ = source_.w;
+    height_ = source_.h;
+    return;
   }
 
-  width_ = surface->w;
-  height_ = surface->h;
-
-  SDL_FreeSurface(surface);
+  cached_ = TextureCache::acquire(path, options);
+  texture_ = cached_->entity();
+  width_ = cached_->width();
+  height_ = cached_->height();
 }
 
+Texture::Texture(TextureCache::Handle texture)
+    : height_(texture->height()),
+      width_(texture->width()),
+      texture_(texture->entity()),
+      cached_(std::move(texture)) {}
+
 Texture::Texture(std::string text, TextTextureMode mode, FontInfo info,
                  Color& fg) {
+  TRUFFLE_TRACE_ZONE("Texture::renderText");
   SDL_Surface* surface;
 
   if (mode == TextTextureMode::Blend)
@@ -77,6 +83,48 @@ Texture::Texture(std::string text, TextTextureMode mode, FontInfo info,
   SDL_FreeSurface(surface);
 }
 
-Texture::~Texture() { SDL_DestroyTexture(texture_); }
+Texture::~Texture() {
+  if (texture_ && !page_ && !cached_) {
+    TextureReaper::retire(texture_);
+  }
+}
+
+Texture::Texture(Texture&& other) noexcept
+    : height_(other.height_),
+      width_(other.width_),
+      texture_(std::exchange(other.texture_, nullptr)),
+      page_(std::move(other.page_)),
+      cached_(std::move(other.cached_)),
+      source_(other.source_) {}
+
+Texture& Texture::operator=(Texture&& other) noexcept {
+  std::swap(height_, other.height_);
+  std::swap(width_, other.width_);
+  std::swap(texture_, other.texture_);
+  std::swap(page_, other.page_);
+  std::swap(cached_, other.cached_);
+  std::swap(source_, other.source_);
+  return *this;
+}
+
+size_t Texture::bytes() const {
+  if (page_ || !texture_) {
+    return 0;
+  }
+  return static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4;
+}
+
+void TextureReaper::retire_(SDL_Texture* texture) {
+  std::unique_lock<std::mutex> l(mux_);
+  retired_.emplace_back(texture);
+}
+
+void TextureReaper::collect_() {
+  std::unique_lock<std::mutex> l(mux_);
+  for (auto* texture : retired_) {
+    SDL_DestroyTexture(texture);
+  }
+  retired_.clear();
+}
 
 }  // namespace Truffle
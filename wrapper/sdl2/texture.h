@@ -11,15 +11,23 @@
 
 #include <SDL2/SDL.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "color.h"
+#include "common/non_copyable.h"
+#include "common/singleton.h"
+#include "texture_cache.h"
 
 namespace Truffle {
 
 // https://www.libsdl.org/projects/SDL_ttf/docs/SDL_ttf_42.html#SEC42
 enum class TextTextureMode { Solid, Blend, Shaded };
 
+class TextureAtlasPage;
+
 struct FontInfo {
   size_t size;
   std::string name;
@@ -27,17 +35,98 @@ struct FontInfo {
 
 class Texture {
  public:
-  Texture(std::string path);
+  /**
+   * テクスチャを持たない空のTexture。entity() はnullptrを返す。
+   */
+  Texture() = default;
+
+  /**
+   * 画像を読み込む。画像がアトラスに詰め込まれていれば、アトラスの一部を参照する。
+   * それ以外は TextureCache を介して、同じ画像を用いるTexture同士でテクスチャを共有する。
+   * マウントしたアセットパックに同じ名前の画像があれば、展開済みの画素列から生成する。
+   * @param path
+   * @param options
+   */
+  Texture(std::string path, const TextureLoadOptions& options = {});
+
+  /**
+   * キャッシュのテクスチャを参照する
+   * @param texture TextureLoader などで読み込んだテクスチャ
+   */
+  explicit Texture(TextureCache::Handle texture);
   Texture(std::string text, TextTextureMode mode, FontInfo info, Color& fg);
   ~Texture();
 
+  Texture(const Texture&) = delete;
+  Texture& operator=(const Texture&) = delete;
+  Texture(Texture&& other) noexcept;
+  Texture& operator=(Texture&& other) noexcept;
+
   int width() const& { return width_; }
   int height() const& { return height_; }
   [[nodiscard]] SDL_Texture const* entity() const& { return texture_; }
 
+  /**
+   * entity() のうちこのテクスチャが占める矩形。テクスチャ全体であればnullptr
+   * @return
+   */
+  [[nodiscard]] const SDL_Rect* sourceRect() const& {
+    return page_ ? &source_ : nullptr;
+  }
+
+  /**
+   * TextureCache のテクスチャを参照しているか。参照を捨てても同じパスから読み込み直せる
+   * @return
+   */
+  [[nodiscard]] bool cached() const { return cached_ != nullptr; }
+
+  /**
+   * 参照しているテクスチャが占めるメモリの見積もり。アトラスの一部であれば、アトラスは
+   * 解放できないので0とする
+   * @return
+   */
+  [[nodiscard]] size_t bytes() const;
+
+ private:
+  int height_ = 0, width_ = 0;
+  SDL_Texture* texture_ = nullptr;
+  // アトラスの一部を参照している場合はアトラスを共有し、texture_ を所有しない
+  std::shared_ptr<const TextureAtlasPage> page_;
+  // キャッシュのテクスチャを参照している場合は texture_ を所有しない
+  TextureCache::Handle cached_;
+  SDL_Rect source_{};
+};
+
+/**
+ * テクスチャの破棄を描画が終わるまで遅延させるクラス。シミュレーションと描画を並行に
+ * 行う場合、破棄されたテクスチャを描画中の命令が参照している可能性があるため、
+ * ディスパッチャーが安全な時点で collect() を呼んで実際に破棄する。
+ */
+class TextureReaper : public MutableSingleton<TextureReaper>, NonCopyable {
+ public:
+  /**
+   * テクスチャを破棄待ちにする
+   * @param texture
+   */
+  static void retire(SDL_Texture* texture) {
+    TextureReaper::get().retire_(texture);
+  }
+
+  /**
+   * 破棄待ちのテクスチャをすべて破棄する。メインスレッドから呼ぶこと。
+   */
+  static void collect() { TextureReaper::get().collect_(); }
+
  private:
-  int height_, width_;
-  SDL_Texture* texture_;
+  friend class MutableSingleton<TextureReaper>;
+
+  TextureReaper() = default;
+
+  void retire_(SDL_Texture* texture);
+  void collect_();
+
+  std::mutex mux_;
+  std::vector<SDL_Texture*> retired_;
 };
 
 }  // namespace Truffle
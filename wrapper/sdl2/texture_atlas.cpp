@@ -0,0 +1,245 @@
+/**
+ * @file      texture_atlas.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Pack images into shared atlas textures
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "texture_atlas.h"
+
+#include <absl/strings/str_format.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "asset_pack.h"
+#include "common/exception.h"
+#include "common/logger.h"
+#include "renderer_storage.h"
+#include "texture.h"
+
+namespace Truffle {
+
+namespace {
+
+struct SurfaceDeleter {
+  void operator()(SDL_Surface* surface) const { SDL_FreeSurface(surface); }
+};
+
+using SurfacePtr = std::unique_ptr<SDL_Surface, SurfaceDeleter>;
+
+SurfacePtr loadRGBA(const std::string& path) {
+  SurfacePtr loaded(AssetPackStorage::loadSurface(path));
+  if (!loaded) {
+    throw TruffleException(
+        absl::StrFormat("Failed to load image: %s", path.c_str()));
+  }
+  SurfacePtr converted(
+      SDL_ConvertSurfaceFormat(loaded.get(), SDL_PIXELFORMAT_RGBA32, 0));
+  if (!converted) {
+    throw TruffleException(
+        absl::StrFormat("Failed to convert image: %s", path.c_str()));
+  }
+  return converted;
+}
+
+}  // namespace
+
+SkylinePacker::SkylinePacker(int width, int height)
+    : width_(width), height_(height), skyline_({Segment{0, 0, width}}) {}
+
+std::optional<int> SkylinePacker::fit(size_t index, int width,
+                                      int height) const {
+  const int x = skyline_[index].x;
+  if (x + width > width_) {
+    return std::nullopt;
+  }
+  int y = 0;
+  int remaining = width;
+  for (size_t i = index; remaining > 0; ++i) {
+    assert(i < skyline_.size());
+    y = std::max(y, skyline_[i].y);
+    if (y + height > height_) {
+      return std::nullopt;
+    }
+    remaining -= skyline_[i].width;
+  }
+  return y;
+}
+
+std::optional<SDL_Point> SkylinePacker::insert(int width, int height) {
+  std::optional<size_t> best_index;
+  int best_bottom = 0;
+  int best_width = 0;
+  for (size_t i = 0; i < skyline_.size(); ++i) {
+    const auto y = fit(i, width, height);
+    if (!y.has_value()) {
+      continue;
+    }
+    const int bottom = *y + height;
+    // 上端が最も低くなる位置を選び、同じであれば隙間の少ない狭い区間を選ぶ
+    if (!best_index.has_value() || bottom < best_bottom ||
+        (bottom == best_bottom && skyline_[i].width < best_width)) {
+      best_index = i;
+      best_bottom = bottom;
+      best_width = skyline_[i].width;
+    }
+  }
+  if (!best_index.has_value()) {
+    return std::nullopt;
+  }
+
+  const SDL_Point position{skyline_[*best_index].x, best_bottom - height};
+  skyline_.insert(skyline_.begin() + *best_index,
+                  Segment{position.x, best_bottom, width});
+
+  // 新しい区間に覆われた区間を縮める、もしくは取り除く
+  const int right = position.x + width;
+  for (size_t i = *best_index + 1; i < skyline_.size();) {
+    auto& segment = skyline_[i];
+    if (segment.x >= right) {
+      break;
+    }
+    const int shrink = right - segment.x;
+    if (segment.width <= shrink) {
+      skyline_.erase(skyline_.begin() + i);
+      continue;
+    }
+    segment.x += shrink;
+    segment.width -= shrink;
+    break;
+  }
+
+  // 同じ高さの隣接する区間を結合する
+  for (size_t i = 0; i + 1 < skyline_.size();) {
+    if (skyline_[i].y == skyline_[i + 1].y) {
+      skyline_[i].width += skyline_[i + 1].width;
+      skyline_.erase(skyline_.begin() + i + 1);
+    } else {
+      ++i;
+    }
+  }
+
+  used_height_ = std::max(used_height_, best_bottom);
+  return position;
+}
+
+TextureAtlasPage::~TextureAtlasPage() { TextureReaper::retire(texture_); }
+
+void TextureAtlas::pack_(const std::vector<std::string>& paths) {
+  struct Source {
+    std::string path;
+    SurfacePtr surface;
+  };
+  struct Placement {
+    size_t source;
+    SDL_Point position;
+  };
+  struct PendingPage {
+    SkylinePacker packer{PAGE_SIZE, PAGE_SIZE};
+    std::vector<Placement> placements;
+  };
+
+  std::unique_lock<std::mutex> l(mux_);
+
+  std::vector<Source> sources;
+  for (const auto& path : paths) {
+    const auto duplicated =
+        std::any_of(sources.begin(), sources.end(),
+                    [&path](const Source& s) { return s.path == path; });
+    if (entries_.contains(path) || duplicated) {
+      continue;
+    }
+    sources.emplace_back(Source{path, loadRGBA(path)});
+  }
+
+  // 高い画像から順に詰めると隙間が少なくなる
+  std::sort(sources.begin(), sources.end(),
+            [](const Source& a, const Source& b) {
+              if (a.surface->h != b.surface->h) {
+                return a.surface->h > b.surface->h;
+              }
+              return a.surface->w > b.surface->w;
+            });
+
+  std::vector<PendingPage> pages;
+  size_t packed = 0;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    const auto& surface = *sources[i].surface;
+    const int width = surface.w + PADDING;
+    const int height = surface.h + PADDING;
+    if (width > PAGE_SIZE || height > PAGE_SIZE) {
+      Logger::log(LogLevel::INFO,
+                  absl::StrFormat("%s is too large for texture atlas",
+                                  sources[i].path));
+      continue;
+    }
+    std::optional<SDL_Point> position;
+    for (auto& page : pages) {
+      if ((position = page.packer.insert(width, height))) {
+        page.placements.emplace_back(Placement{i, *position});
+        break;
+      }
+    }
+    if (!position.has_value()) {
+      auto& page = pages.emplace_back();
+      position = page.packer.insert(width, height);
+      assert(position.has_value());
+      page.placements.emplace_back(Placement{i, *position});
+    }
+    ++packed;
+  }
+
+  auto* renderer = const_cast<SDL_Renderer*>(
+      RendererStorage::get().activeRenderer()->entity());
+  for (const auto& page : pages) {
+    SurfacePtr canvas(SDL_CreateRGBSurfaceWithFormat(
+        0, PAGE_SIZE, page.packer.usedHeight(), 32, SDL_PIXELFORMAT_RGBA32));
+    if (!canvas) {
+      throw TruffleException("Failed to create texture atlas surface");
+    }
+    for (const auto& [source, position] : page.placements) {
+      auto* surface = sources[source].surface.get();
+      SDL_Rect dst{position.x, position.y, surface->w, surface->h};
+      // アルファ値も含めてそのまま書き込む
+      SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(surface, nullptr, canvas.get(), &dst);
+    }
+
+    auto* texture = SDL_CreateTextureFromSurface(renderer, canvas.get());
+    if (!texture) {
+      throw TruffleException("Failed to create texture atlas");
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    auto shared_page = std::make_shared<const TextureAtlasPage>(texture);
+
+    for (const auto& [source, position] : page.placements) {
+      const auto* surface = sources[source].surface.get();
+      entries_.emplace(sources[source].path,
+                       TextureAtlasEntry{shared_page,
+                                         SDL_Rect{position.x, position.y,
+                                                  surface->w, surface->h}});
+    }
+  }
+
+  Logger::log(LogLevel::INFO,
+              absl::StrFormat("packed %d images into %d texture atlas pages",
+                              packed, pages.size()));
+}
+
+std::optional<TextureAtlasEntry> TextureAtlas::find_(const std::string& path) {
+  std::unique_lock<std::mutex> l(mux_);
+  const auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void TextureAtlas::clear_() {
+  std::unique_lock<std::mutex> l(mux_);
+  entries_.clear();
+}
+
+}  // namespace Truffle
@@ -0,0 +1,137 @@
+/**
+ * @file      texture_atlas.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Pack images into shared atlas textures
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_TEXTURE_ATLAS_H
+#define TRUFFLE_TEXTURE_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/non_copyable.h"
+#include "common/singleton.h"
+
+namespace Truffle {
+
+/**
+ * Skylineアルゴリズム(Bottom-Left)による矩形の詰め込み
+ */
+class SkylinePacker {
+ public:
+  SkylinePacker(int width, int height);
+
+  /**
+   * 矩形を配置する
+   * @param width
+   * @param height
+   * @return 配置された左上の座標。空きがなければnullopt
+   */
+  std::optional<SDL_Point> insert(int width, int height);
+
+  /**
+   * 配置済みの矩形が占める高さ
+   * @return
+   */
+  [[nodiscard]] int usedHeight() const { return used_height_; }
+
+ private:
+  struct Segment {
+    int x;
+    int y;
+    int width;
+  };
+
+  // index番目の区間から幅widthの矩形を置いた時の上端。置けなければnullopt
+  std::optional<int> fit(size_t index, int width, int height) const;
+
+  const int width_;
+  const int height_;
+  int used_height_ = 0;
+  std::vector<Segment> skyline_;
+};
+
+/**
+ * 複数の画像を詰め込んだ1枚のテクスチャ。TextureAtlasが所有するので、
+ * TextureAtlas::clear() が呼ばれ、かつ参照するTextureがすべて破棄されるまで残る。
+ */
+class TextureAtlasPage : NonCopyable {
+ public:
+  explicit TextureAtlasPage(SDL_Texture* texture) : texture_(texture) {}
+  ~TextureAtlasPage();
+
+  [[nodiscard]] SDL_Texture* entity() const { return texture_; }
+
+ private:
+  SDL_Texture* texture_;
+};
+
+/**
+ * アトラス内の1枚の画像の位置
+ */
+struct TextureAtlasEntry {
+  std::shared_ptr<const TextureAtlasPage> page;
+  SDL_Rect rect;
+};
+
+/**
+ * 画像をアトラスに詰め込み、パス毎にアトラス内の位置を引けるようにするクラス。
+ * 詰め込まれた画像は Texture(path) がアトラスの一部として参照するので、同じアトラスの
+ * 画像は1回の描画呼び出しにまとめて描画できる。
+ */
+class TextureAtlas : public MutableSingleton<TextureAtlas>, NonCopyable {
+ public:
+  // アトラス1枚の大きさ。多くの環境でテクスチャの最大サイズを下回る
+  static constexpr int PAGE_SIZE = 2048;
+  // 隣接する画像の色がフィルタリングで滲まないように空ける間隔
+  static constexpr int PADDING = 1;
+
+  /**
+   * 画像を読み込んでアトラスに詰め込む。詰め込み済みの画像と1枚のアトラスに
+   * 収まらない画像は無視される。シーンのオブジェクトを生成する前にメインスレッドから呼ぶこと。
+   * @param paths 画像のパス
+   */
+  static void pack(const std::vector<std::string>& paths) {
+    TextureAtlas::get().pack_(paths);
+  }
+
+  /**
+   * 画像がアトラスに詰め込まれていればその位置を返す
+   * @param path
+   * @return
+   */
+  static std::optional<TextureAtlasEntry> find(const std::string& path) {
+    return TextureAtlas::get().find_(path);
+  }
+
+  /**
+   * 登録を破棄する。既に生成されたTextureが参照しているアトラスは、それらが
+   * 破棄されるまで残る。
+   */
+  static void clear() { TextureAtlas::get().clear_(); }
+
+ private:
+  friend class MutableSingleton<TextureAtlas>;
+
+  TextureAtlas() = default;
+
+  void pack_(const std::vector<std::string>& paths);
+  std::optional<TextureAtlasEntry> find_(const std::string& path);
+  void clear_();
+
+  std::mutex mux_;
+  absl::flat_hash_map<std::string, TextureAtlasEntry> entries_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_TEXTURE_ATLAS_H
@@ -0,0 +1,196 @@
+/**
+ * @file      texture_cache.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Shared image textures keyed by canonical path and load options
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "texture_cache.h"
+
+#include <absl/strings/str_format.h>
+
+#include <filesystem>
+#include <system_error>
+
+#include "asset_pack.h"
+#include "common/exception.h"
+#include "common/trace.h"
+#include "renderer_storage.h"
+#include "texture.h"
+
+namespace Truffle {
+
+CachedTexture::CachedTexture(SDL_Texture* texture, int width, int height)
+    : texture_(texture), width_(width), height_(height) {}
+
+CachedTexture::~CachedTexture() { TextureReaper::retire(texture_); }
+
+std::string TextureCache::canonicalPath(const std::string& path) {
+  // 相対パスのままでは存在しないパスの正規化結果が表記によって変わるので、
+  // 先に絶対パスにする
+  std::error_code error;
+  const auto absolute = std::filesystem::absolute(path, error);
+  if (error) {
+    return std::filesystem::path(path).lexically_normal().string();
+  }
+  const auto canonical = std::filesystem::weakly_canonical(absolute, error);
+  if (error) {
+    return absolute.lexically_normal().string();
+  }
+  return canonical.string();
+}
+
+TextureCache::Handle TextureCache::acquire_(const std::string& path,
+                                            const TextureLoadOptions& options) {
+  Key key{canonicalPath(path), options.blend_mode};
+  std::unique_lock<std::mutex> l(mux_);
+  if (auto handle = lookup(key)) {
+    return handle;
+  }
+
+  TRUFFLE_TRACE_ZONE("TextureCache::load");
+  SDL_Surface* surface = AssetPackStorage::loadSurface(path);
+  if (!surface) {
+    throw TruffleException(
+        absl::StrFormat("Failed to load image: %s", path.c_str()));
+  }
+  try {
+    auto handle = create(std::move(key), surface);
+    SDL_FreeSurface(surface);
+    return handle;
+  } catch (...) {
+    SDL_FreeSurface(surface);
+    throw;
+  }
+}
+
+TextureCache::Handle TextureCache::find_(const std::string& path,
+                                         const TextureLoadOptions& options) {
+  const Key key{canonicalPath(path), options.blend_mode};
+  std::unique_lock<std::mutex> l(mux_);
+  return lookup(key);
+}
+
+TextureCache::Handle TextureCache::insert_(const std::string& path,
+                                           const TextureLoadOptions& options,
+                                           SDL_Surface* surface) {
+  Key key{canonicalPath(path), options.blend_mode};
+  std::unique_lock<std::mutex> l(mux_);
+  // 呼び出し元が find() で既に数えているので、ヒットとミスは数えない
+  if (const auto it = entries_.find(key); it != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.recent);
+    return it->second.texture;
+  }
+  return create(std::move(key), surface);
+}
+
+TextureCache::Handle TextureCache::lookup(const Key& key) {
+  const auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.recent);
+  return it->second.texture;
+}
+
+TextureCache::Handle TextureCache::create(Key key, SDL_Surface* surface) {
+  auto* texture = SDL_CreateTextureFromSurface(
+      const_cast<SDL_Renderer*>(
+          RendererStorage::get().activeRenderer()->entity()),
+      surface);
+  if (!texture) {
+    throw TruffleException(absl::StrFormat(
+        "Failed to create texture entity from %s", key.first));
+  }
+  SDL_SetTextureBlendMode(texture, key.second);
+
+  auto handle =
+      std::make_shared<const CachedTexture>(texture, surface->w, surface->h);
+  bytes_ += handle->bytes();
+  lru_.emplace_front(key);
+  entries_.emplace(std::move(key), Slot{handle, lru_.begin()});
+  // 生成したテクスチャは参照されているので追い出されない
+  evict(budget_);
+  return handle;
+}
+
+void TextureCache::setBudget_(size_t bytes) {
+  std::unique_lock<std::mutex> l(mux_);
+  budget_ = bytes;
+  evict(budget_);
+}
+
+void TextureCache::trim_() {
+  std::unique_lock<std::mutex> l(mux_);
+  evict(budget_);
+}
+
+void TextureCache::clear_() {
+  std::unique_lock<std::mutex> l(mux_);
+  evict(0);
+}
+
+std::vector<TextureCache::Key> TextureCache::referenced_() {
+  std::unique_lock<std::mutex> l(mux_);
+  std::vector<Key> keys;
+  for (const auto& [key, slot] : entries_) {
+    if (slot.texture.use_count() > 1) {
+      keys.emplace_back(key);
+    }
+  }
+  return keys;
+}
+
+size_t TextureCache::evictUnreferenced_(absl::Span<const Key> keys) {
+  std::unique_lock<std::mutex> l(mux_);
+  size_t evicted = 0;
+  for (const auto& key : keys) {
+    const auto entry = entries_.find(key);
+    if (entry == entries_.end() || entry->second.texture.use_count() > 1) {
+      continue;
+    }
+    const auto bytes = entry->second.texture->bytes();
+    bytes_ -= bytes;
+    evicted += bytes;
+    ++evictions_;
+    lru_.erase(entry->second.recent);
+    entries_.erase(entry);
+  }
+  return evicted;
+}
+
+TextureCacheStats TextureCache::stats_() {
+  std::unique_lock<std::mutex> l(mux_);
+  TextureCacheStats stats;
+  stats.entries = entries_.size();
+  stats.bytes = bytes_;
+  for (const auto& [_, slot] : entries_) {
+    if (slot.texture.use_count() > 1) {
+      stats.referenced_bytes += slot.texture->bytes();
+    }
+  }
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  return stats;
+}
+
+void TextureCache::evict(size_t budget) {
+  for (auto it = lru_.end(); it != lru_.begin() && bytes_ > budget;) {
+    --it;
+    const auto entry = entries_.find(*it);
+    // Textureから参照されているものは追い出せない
+    if (entry->second.texture.use_count() > 1) {
+      continue;
+    }
+    bytes_ -= entry->second.texture->bytes();
+    ++evictions_;
+    entries_.erase(entry);
+    it = lru_.erase(it);
+  }
+}
+
+}  // namespace Truffle
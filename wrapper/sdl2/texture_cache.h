@@ -0,0 +1,232 @@
+/**
+ * @file      texture_cache.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Shared image textures keyed by canonical path and load options
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_TEXTURE_CACHE_H
+#define TRUFFLE_TEXTURE_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/non_copyable.h"
+#include "common/singleton.h"
+
+namespace Truffle {
+
+/**
+ * 画像からテクスチャを生成する際の設定。設定が異なれば別のテクスチャとして扱う。
+ */
+struct TextureLoadOptions {
+  // 描画時のブレンドモード
+  SDL_BlendMode blend_mode = SDL_BLENDMODE_BLEND;
+
+  bool operator==(const TextureLoadOptions& other) const {
+    return blend_mode == other.blend_mode;
+  }
+};
+
+/**
+ * キャッシュが保持する1枚のテクスチャ。参照がなくなっても、キャッシュから追い出されるまでは
+ * 破棄されない。
+ */
+class CachedTexture : NonCopyable {
+ public:
+  CachedTexture(SDL_Texture* texture, int width, int height);
+  ~CachedTexture();
+
+  [[nodiscard]] SDL_Texture* entity() const { return texture_; }
+  [[nodiscard]] int width() const { return width_; }
+  [[nodiscard]] int height() const { return height_; }
+
+  /**
+   * テクスチャが占めるメモリの見積もり。1画素4バイトとして数える
+   * @return
+   */
+  [[nodiscard]] size_t bytes() const {
+    return static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4;
+  }
+
+ private:
+  SDL_Texture* texture_;
+  int width_;
+  int height_;
+};
+
+struct TextureCacheStats {
+  size_t entries = 0;
+  // 保持しているすべてのテクスチャのバイト数
+  size_t bytes = 0;
+  // Textureから参照されているテクスチャのバイト数。追い出すことはできない
+  size_t referenced_bytes = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+/**
+ * 画像のテクスチャを正規化したパスと読み込み設定毎に共有するクラス。同じ画像を用いる
+ * オブジェクトは1枚のテクスチャを参照するので、画像の展開と転送は1度で済む。
+ * 参照されていないテクスチャは予算を超えるまで保持し、超えた時点で最も長く使われて
+ * いないものから追い出す。メインスレッドから使うこと。
+ */
+class TextureCache : public MutableSingleton<TextureCache>, NonCopyable {
+ public:
+  using Handle = std::shared_ptr<const CachedTexture>;
+  // 正規化したパスとブレンドモード
+  using Key = std::pair<std::string, SDL_BlendMode>;
+
+  // 既定のメモリ予算(バイト)
+  static constexpr size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+  /**
+   * 画像のテクスチャを返す。キャッシュになければ読み込む。
+   * @param path
+   * @param options
+   * @return 参照がある間は破棄されないテクスチャ
+   */
+  static Handle acquire(const std::string& path,
+                        const TextureLoadOptions& options = {}) {
+    return TextureCache::get().acquire_(path, options);
+  }
+
+  /**
+   * キャッシュにあればテクスチャを返す。読み込みは行わない。
+   * @param path
+   * @param options
+   * @return キャッシュになければnullptr
+   */
+  static Handle find(const std::string& path,
+                     const TextureLoadOptions& options = {}) {
+    return TextureCache::get().find_(path, options);
+  }
+
+  /**
+   * 展開済みの画像からテクスチャを生成して登録する。既に登録されていれば
+   * 登録済みのテクスチャを返す。
+   * @param path
+   * @param options
+   * @param surface 展開済みの画像。所有権は移らない
+   * @return
+   */
+  static Handle insert(const std::string& path,
+                       const TextureLoadOptions& options,
+                       SDL_Surface* surface) {
+    return TextureCache::get().insert_(path, options, surface);
+  }
+
+  /**
+   * メモリ予算を設定し、超えていれば参照されていないテクスチャを追い出す
+   * @param bytes
+   */
+  static void setBudget(size_t bytes) { TextureCache::get().setBudget_(bytes); }
+
+  /**
+   * 予算を超えている分だけ参照されていないテクスチャを追い出す
+   */
+  static void trim() { TextureCache::get().trim_(); }
+
+  /**
+   * 参照されていないテクスチャをすべて追い出す
+   */
+  static void clear() { TextureCache::get().clear_(); }
+
+  /**
+   * Textureから参照されているテクスチャのキー。evictUnreferenced() と組み合わせて、
+   * 参照を捨てさせたテクスチャのみを追い出すために用いる
+   * @return
+   */
+  static std::vector<Key> referenced() {
+    return TextureCache::get().referenced_();
+  }
+
+  /**
+   * 与えたキーのテクスチャのうち参照されていないものを、予算に関わらず追い出す
+   * @param keys
+   * @return 追い出したテクスチャのバイト数
+   */
+  static size_t evictUnreferenced(absl::Span<const Key> keys) {
+    return TextureCache::get().evictUnreferenced_(keys);
+  }
+
+  static TextureCacheStats stats() { return TextureCache::get().stats_(); }
+
+  /**
+   * キャッシュのキーに用いる正規化したパス
+   * @param path
+   * @return
+   */
+  static std::string canonicalPath(const std::string& path);
+
+ private:
+  friend class MutableSingleton<TextureCache>;
+
+  struct Slot {
+    Handle texture;
+    // lru_ 内の位置
+    std::list<Key>::iterator recent;
+  };
+
+  TextureCache() = default;
+
+  Handle acquire_(const std::string& path, const TextureLoadOptions& options);
+  Handle find_(const std::string& path, const TextureLoadOptions& options);
+  Handle insert_(const std::string& path, const TextureLoadOptions& options,
+                 SDL_Surface* surface);
+  void setBudget_(size_t bytes);
+  void trim_();
+  void clear_();
+  std::vector<Key> referenced_();
+  size_t evictUnreferenced_(absl::Span<const Key> keys);
+  TextureCacheStats stats_();
+
+  /**
+   * キャッシュにあればテクスチャを返し、最近使われたものとする。
+   * mux_ を獲得した状態で呼ぶこと。
+   * @param key
+   * @return
+   */
+  Handle lookup(const Key& key);
+
+  /**
+   * 画像からテクスチャを生成して登録する。mux_ を獲得した状態で呼ぶこと。
+   * @param key
+   * @param surface
+   * @return
+   */
+  Handle create(Key key, SDL_Surface* surface);
+
+  /**
+   * 予算に収まるまで、最も長く使われていない参照のないテクスチャを追い出す。
+   * mux_ を獲得した状態で呼ぶこと。
+   * @param budget
+   */
+  void evict(size_t budget);
+
+  std::mutex mux_;
+  absl::flat_hash_map<Key, Slot> entries_;
+  // 先頭ほど最近使われた
+  std::list<Key> lru_;
+  size_t budget_ = DEFAULT_BUDGET;
+  size_t bytes_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_TEXTURE_CACHE_H
@@ -0,0 +1,153 @@
+/**
+ * @file      texture_loader.cpp
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Image decoding on worker threads with budgeted texture uploads
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#include "texture_loader.h"
+
+#include <absl/strings/str_format.h>
+
+#include "asset_pack.h"
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/trace.h"
+
+namespace Truffle {
+
+void AsyncTexture::onComplete(std::function<void()> callback) {
+  // 呼び出した関数がこのハンドルを破棄してもよいように、状態を手元に保持する
+  const auto state = state_;
+  if (!state) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> l(state->mux);
+    if (state->status.load() == Status::Pending) {
+      state->callback = std::move(callback);
+      return;
+    }
+  }
+  callback();
+}
+
+void AsyncTexture::cancel() {
+  if (!state_) {
+    return;
+  }
+  std::unique_lock<std::mutex> l(state_->mux);
+  state_->callback = nullptr;
+}
+
+AsyncTexture TextureLoader::load_(const std::string& path,
+                                  const TextureLoadOptions& options) {
+  auto state = std::make_shared<AsyncTexture::State>();
+  state->path = path;
+  state->options = options;
+  if (auto cached = TextureCache::find(path, options)) {
+    state->texture = std::move(cached);
+    state->status = AsyncTexture::Status::Ready;
+    return AsyncTexture(std::move(state));
+  }
+
+  Key key{TextureCache::canonicalPath(path), options.blend_mode};
+  std::unique_lock<std::mutex> l(mux_);
+  if (const auto it = in_flight_.find(key); it != in_flight_.end()) {
+    it->second->waiters.emplace_back(state);
+    return AsyncTexture(std::move(state));
+  }
+
+  auto decode = std::make_shared<Decode>();
+  decode->key = key;
+  decode->path = path;
+  decode->options = options;
+  decode->waiters.emplace_back(state);
+  in_flight_.emplace(std::move(key), decode);
+  pending_.fetch_add(1);
+  l.unlock();
+
+  pool_.submit([this, decode] { this->decode(decode); });
+  return AsyncTexture(std::move(state));
+}
+
+size_t TextureLoader::pump_(std::chrono::steady_clock::duration budget) {
+  if (pending_.load() == 0) {
+    return 0;
+  }
+  TRUFFLE_TRACE_ZONE("TextureLoader::pump");
+  const auto start = std::chrono::steady_clock::now();
+  size_t completed = 0;
+  do {
+    std::shared_ptr<Decode> decode;
+    {
+      std::unique_lock<std::mutex> l(mux_);
+      if (decoded_.empty()) {
+        break;
+      }
+      decode = std::move(decoded_.front());
+      decoded_.pop_front();
+    }
+    upload(decode);
+    ++completed;
+  } while (std::chrono::steady_clock::now() - start < budget);
+  return completed;
+}
+
+void TextureLoader::decode(const std::shared_ptr<Decode>& decode) {
+  {
+    TRUFFLE_TRACE_ZONE("TextureLoader::decode");
+    decode->surface = AssetPackStorage::loadSurface(decode->path);
+    if (!decode->surface) {
+      decode->error = SDL_GetError();
+    }
+  }
+  std::unique_lock<std::mutex> l(mux_);
+  decoded_.emplace_back(decode);
+}
+
+void TextureLoader::upload(const std::shared_ptr<Decode>& decode) {
+  TRUFFLE_TRACE_ZONE("TextureLoader::upload");
+  TextureCache::Handle texture;
+  if (decode->surface) {
+    try {
+      texture = TextureCache::insert(decode->path, decode->options,
+                                     decode->surface);
+    } catch (const TruffleException& e) {
+      decode->error = e.what();
+    }
+    SDL_FreeSurface(decode->surface);
+    decode->surface = nullptr;
+  }
+  if (!texture) {
+    Logger::log(LogLevel::WARN,
+                absl::StrFormat("Failed to load image: %s: %s", decode->path,
+                                decode->error));
+  }
+
+  // キャッシュに登録した後で外すので、以降の load() はキャッシュから返る
+  std::vector<std::shared_ptr<AsyncTexture::State>> waiters;
+  {
+    std::unique_lock<std::mutex> l(mux_);
+    in_flight_.erase(decode->key);
+    waiters.swap(decode->waiters);
+  }
+  pending_.fetch_sub(1);
+
+  for (auto& state : waiters) {
+    std::function<void()> callback;
+    {
+      std::unique_lock<std::mutex> l(state->mux);
+      state->texture = texture;
+      state->status = texture ? AsyncTexture::Status::Ready
+                              : AsyncTexture::Status::Failed;
+      callback = std::move(state->callback);
+    }
+    if (callback) {
+      callback();
+    }
+  }
+}
+
+}  // namespace Truffle
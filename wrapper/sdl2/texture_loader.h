@@ -0,0 +1,212 @@
+/**
+ * @file      texture_loader.h
+ * @author    Rei Shimizu (shikugawa) <shikugawa@gmail.com>
+ * @brief     Image decoding on worker threads with budgeted texture uploads
+ *
+ * @copyright Copyright 2021 Rei Shimizu. All rights reserved.
+ */
+
+#ifndef TRUFFLE_TEXTURE_LOADER_H
+#define TRUFFLE_TEXTURE_LOADER_H
+
+#include <SDL2/SDL.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/job_pool.h"
+#include "common/non_copyable.h"
+#include "common/singleton.h"
+#include "texture_cache.h"
+
+namespace Truffle {
+
+/**
+ * TextureLoader::load() の結果を参照するハンドル。読み込みが完了するまではテクスチャを
+ * 持たない。状態の参照はどのスレッドからでも行える。
+ */
+class AsyncTexture {
+ public:
+  AsyncTexture() = default;
+
+  /**
+   * 読み込みを参照しているか
+   * @return
+   */
+  [[nodiscard]] bool valid() const { return state_ != nullptr; }
+
+  /**
+   * 読み込み中か
+   * @return
+   */
+  [[nodiscard]] bool pending() const {
+    return valid() && state_->status.load() == Status::Pending;
+  }
+
+  /**
+   * テクスチャが利用可能か
+   * @return
+   */
+  [[nodiscard]] bool ready() const {
+    return valid() && state_->status.load() == Status::Ready;
+  }
+
+  /**
+   * 読み込みに失敗したか
+   * @return
+   */
+  [[nodiscard]] bool failed() const {
+    return valid() && state_->status.load() == Status::Failed;
+  }
+
+  /**
+   * 読み込んでいる画像のパス
+   * @return
+   */
+  [[nodiscard]] const std::string& path() const& { return state_->path; }
+
+  /**
+   * 読み込みの設定
+   * @return
+   */
+  [[nodiscard]] const TextureLoadOptions& options() const& {
+    return state_->options;
+  }
+
+  /**
+   * 読み込んだテクスチャ。ready() の時のみ有効
+   * @return
+   */
+  [[nodiscard]] const TextureCache::Handle& texture() const& {
+    return state_->texture;
+  }
+
+  /**
+   * 読み込みが完了した時に呼ぶ関数を設定する。既に完了していればその場で呼ぶ。
+   * 読み込み中であれば TextureLoader::pump() の中でメインスレッドから呼ばれる。
+   * 失敗した場合も呼ばれる。
+   * @param callback
+   */
+  void onComplete(std::function<void()> callback);
+
+  /**
+   * onComplete() で設定した関数を呼ばないようにする。関数が参照するオブジェクトを
+   * 破棄する前に呼ぶこと。
+   */
+  void cancel();
+
+ private:
+  friend class TextureLoader;
+
+  enum class Status { Pending, Ready, Failed };
+
+  struct State {
+    std::string path;
+    TextureLoadOptions options;
+    std::atomic<Status> status{Status::Pending};
+    // status が Ready になる前に設定される
+    TextureCache::Handle texture;
+    std::mutex mux;
+    std::function<void()> callback;
+  };
+
+  explicit AsyncTexture(std::shared_ptr<State> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<State> state_;
+};
+
+/**
+ * 画像の展開をワーカースレッドで行い、テクスチャの生成のみをメインスレッドで行うクラス。
+ * テクスチャの生成は pump() でフレーム毎の時間予算内に収まる分だけ行うので、
+ * 多数の画像を読み込んでもフレームが止まらない。生成したテクスチャは TextureCache に
+ * 登録され、同期的に読み込んだTextureとも共有される。
+ */
+class TextureLoader : public MutableSingleton<TextureLoader>, NonCopyable {
+ public:
+  // 画像の展開に用いるワーカースレッド数
+  static constexpr size_t WORKER_THREADS = 2;
+
+  /**
+   * 画像の読み込みを開始する。キャッシュにあれば読み込み済みのハンドルを返す。
+   * 同じ画像の読み込み中であれば展開は1度しか行わない。SDLのテクスチャを生成しない
+   * ので、どのスレッドからでも呼べる。
+   * @param path
+   * @param options
+   * @return
+   */
+  static AsyncTexture load(const std::string& path,
+                           const TextureLoadOptions& options = {}) {
+    return TextureLoader::get().load_(path, options);
+  }
+
+  /**
+   * 展開が終わった画像からテクスチャを生成する。1枚は必ず生成し、それ以降は経過時間が
+   * 予算を超えるまで生成する。完了したハンドルの onComplete() もここで呼ばれる。
+   * メインスレッドから、描画中の命令もシミュレーションも存在しない時点で呼ぶこと。
+   * @param budget
+   * @return 完了した画像の数
+   */
+  static size_t pump(std::chrono::steady_clock::duration budget) {
+    return TextureLoader::get().pump_(budget);
+  }
+
+  /**
+   * 展開中もしくはテクスチャの生成待ちの画像の数
+   * @return
+   */
+  static size_t pending() { return TextureLoader::get().pending_.load(); }
+
+ private:
+  friend class MutableSingleton<TextureLoader>;
+
+  using Key = std::pair<std::string, SDL_BlendMode>;
+
+  // 1枚の画像の展開。同じ画像を待つハンドルをまとめて完了させる
+  struct Decode {
+    Key key;
+    std::string path;
+    TextureLoadOptions options;
+    SDL_Surface* surface = nullptr;
+    std::string error;
+    std::vector<std::shared_ptr<AsyncTexture::State>> waiters;
+  };
+
+  TextureLoader() : pool_(WORKER_THREADS) {}
+
+  AsyncTexture load_(const std::string& path,
+                     const TextureLoadOptions& options);
+  size_t pump_(std::chrono::steady_clock::duration budget);
+
+  /**
+   * ワーカースレッドで画像を展開し、生成待ちに積む
+   * @param decode
+   */
+  void decode(const std::shared_ptr<Decode>& decode);
+
+  /**
+   * 展開した画像からテクスチャを生成し、待っているハンドルを完了させる
+   * @param decode
+   */
+  void upload(const std::shared_ptr<Decode>& decode);
+
+  std::mutex mux_;
+  absl::flat_hash_map<Key, std::shared_ptr<Decode>> in_flight_;
+  // 展開が終わりテクスチャの生成を待つ画像
+  std::deque<std::shared_ptr<Decode>> decoded_;
+  std::atomic<size_t> pending_{0};
+  JobPool pool_;
+};
+
+}  // namespace Truffle
+
+#endif  // TRUFFLE_TEXTURE_LOADER_H
@@ -14,11 +14,11 @@
 
 namespace Truffle {
 
-Window::Window(std::string name, int width, int height)
+Window::Window(std::string name, int width, int height, uint32_t flags)
     : name_(name), width_(width), height_(height) {
   window_entity_ = SDL_CreateWindow(name_.c_str(), SDL_WINDOWPOS_UNDEFINED,
                                     SDL_WINDOWPOS_UNDEFINED, width_, height_,
-                                    SDL_WINDOW_SHOWN);
+                                    flags);
   if (!window_entity_) {
     throw TruffleException(
         absl::StrFormat("Failed to create %s window", name_));
@@ -28,7 +28,8 @@ class Window : public ConstSingleton<Window>, NonCopyable {
  private:
   friend class ConstSingleton<Window>;
 
-  Window(std::string name, int width, int height);
+  Window(std::string name, int width, int height,
+         uint32_t flags = SDL_WINDOW_SHOWN);
 
   SDL_Window* window_entity_;
   const std::string name_;